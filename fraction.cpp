@@ -0,0 +1,38 @@
+/*
+ * fraction.cpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// The one translation unit that instantiates the common fractions, for
+// builds that define FRACTION_EXTERN_TEMPLATES everywhere else. It needs
+// GNU extensions (-std=gnu++20) for fraction< __int128 >:
+//   g++ -std=gnu++20 -O2 -c fraction.cpp
+
+#include "fraction.hpp"
+
+namespace mth {
+
+template class fraction< std::int32_t >;
+template class fraction< std::int64_t >;
+#if defined( __SIZEOF_INT128__ ) && !defined( __STRICT_ANSI__ )
+template class fraction< detail::int128_t >;
+#endif
+
+}; // namespace mth
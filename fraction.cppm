@@ -0,0 +1,93 @@
+/*
+ * fraction.cppm
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// The mth.fraction module, for translation units that
+//   import mth.fraction;
+// rather than #include "fraction.hpp", which stays for those that do not.
+// fraction.hpp and the standard headers it needs are parsed once, when the
+// module is built, and fraction<> (std::int64_t, -6) with its converters is
+// instantiated once, into the module's object file, rather than in every
+// translation unit that uses it. The companion fraction_*.hpp headers are
+// not part of the module and still include fraction.hpp. Built with e.g.
+//   g++ -std=c++20 -fmodules-ts -c -x c++ fraction.cppm
+//   clang++ -std=c++20 --precompile fraction.cppm -o mth.fraction.pcm
+// Caveats with GCC 12's modules:
+// - An importer that also includes <iostream>, <string> or other standard
+//   headers before the import, or imports them as header units, can hit
+//   internal compiler errors.
+// - The text forms that return or take a std::string (to_string(), + with
+//   strings and <<) are not dependable across the module. + with a string
+//   does not compile in an importer, and to_string() can be left undefined
+//   at link time, as the importer may mangle it without the [abi:cxx11]
+//   tag of the definition here. to_chars() has no std::string in its
+//   signature and is prebuilt below, so importers should write fractions
+//   with it, or include fraction.hpp rather than import the module where
+//   they need the std::string forms.
+
+module;
+
+// Everything fraction.hpp and the headers it includes include, so that
+// including it below adds only their own declarations to the module.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <complex>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <ranges>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+export module mth.fraction;
+
+#define FRACTION_EXPORT export
+#include "fraction.hpp"
+
+// Prebuilt instantiations of the default fraction.
+template class mth::fraction< std::int64_t, -6 >;
+template mth::fraction< std::int64_t, -6 >
+mth::to_fraction_using_stern_brocot_with_mediants< std::int64_t, -6 >(
+	const double ) noexcept;
+template std::array< std::int64_t, 25 >
+mth::to_continued_fraction< 25, std::int64_t, -6 >( const double ) noexcept;
+template mth::fraction< std::int64_t, -6 >
+mth::to_fraction< std::int64_t, -6 >( const std::span< std::int64_t > & ) noexcept;
+template mth::fraction< std::int64_t, -6 >
+mth::to_fraction_using_continued_fractions< 25, std::int64_t, -6 >(
+	const double ) noexcept;
+template std::to_chars_result
+mth::to_chars< std::int64_t, -6 >( char *, char *const,
+								   const mth::fraction< std::int64_t, -6 > & ) noexcept;
@@ -0,0 +1,251 @@
+/*
+ * fraction_affine.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Exact 2D and 3D affine maps with fraction coefficients, applied to arrays
+// of points held as one fraction_soa per coordinate.
+// The matrix is brought to a common denominator D once, leaving integer
+// coefficients. Each point is brought to a common denominator q (nothing to
+// do when its coordinates already share one, e.g. as decoded from a
+// for_column), then every output coordinate is
+//   ( sum a_rc * n_c + a_r * q ) / ( D * q )
+// accumulated in widened integers (int64 for int32, __int128 for int64),
+// with a single gcd per coordinate at the end to reduce it.
+// Points are done in blocks: scale, multiply and accumulate, then reduce,
+// each as its own loop. When the coefficients are small enough that no sum
+// can overflow, which from_matrix() works out once, the multiply and
+// accumulate loop is plain integer arithmetic that the compiler vectorises
+// (for int32 at least), otherwise each step is checked for overflow.
+
+#ifndef FRACTION_AFFINE_HPP
+#define FRACTION_AFFINE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+template< std::integral INT = std::int64_t, int error_exp = -6, std::size_t dim = 2 >
+class affine {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	// Row r maps a point p to sum( m[r][c] * p[c] ) + m[r][dim].
+	using matrix = std::array< std::array< fraction_type, dim + 1 >, dim >;
+	// One column per coordinate.
+	using points = std::array< fraction_soa< INT >, dim >;
+
+	// Nothing if a denominator is 0 or the common denominator overflows INT.
+	[[nodiscard]] static std::optional< affine > from_matrix( const matrix &m ) {
+		affine result;
+		for ( const auto &row : m ) {
+			for ( const auto &f : row ) {
+				if ( f.den() == 0 ) {
+					return std::nullopt;
+				};
+				if ( result.den % f.den() != 0 ) {
+					const auto lcm = detail::checked_mul(
+						result.den / std::gcd( result.den, f.den() ), f.den() );
+					if ( !lcm ) {
+						return std::nullopt;
+					};
+					result.den = *lcm;
+				};
+			};
+		};
+		for ( std::size_t r = 0; r != dim; ++r ) {
+			for ( std::size_t c = 0; c != dim + 1; ++c ) {
+				const auto a = detail::checked_mul( m[r][c].num(),
+													result.den / m[r][c].den() );
+				if ( !a ) {
+					return std::nullopt;
+				};
+				result.coef[r][c] = *a;
+			};
+		};
+		// Whether no sum can overflow, whatever the point, whose coordinates
+		// may be as large as the most negative INT.
+		// numeric_limits is not specialised for __int128 in strict mode.
+		const auto limit =
+			( ~(uwide)0 >> 1 ) / ( (uwide)std::numeric_limits< INT >::max() + 1 );
+		result.exact = std::ranges::all_of( result.coef, [&]( const auto &row ) {
+			uwide total = 0;
+			for ( const INT a : row ) {
+				total += std::min( (uwide)detail::uabs( a ), limit );
+			};
+			return total < limit;
+		} );
+		return result;
+	};
+
+	// Map every point of from to to, which may be the same. Denominators must
+	// be positive. A point with a coordinate that does not fit in INT is set
+	// to 0/0. Returns the number of such points.
+	std::size_t apply( const points &from, points &to ) const {
+		const std::size_t size = from[0].size();
+		for ( auto &column : to ) {
+			column.resize( size );
+		};
+		std::size_t failed = 0;
+		std::array< std::array< INT, block >, dim > scaled{};
+		std::array< INT, block > shared{};
+		std::array< std::array< wide, block >, dim > sums{};
+		std::array< bool, block > overflow{};
+		for ( std::size_t start = 0; start < size; start += block ) {
+			const std::size_t count = std::min( block, size - start );
+			for ( std::size_t i = 0; i != count; ++i ) {
+				overflow[i] = !scale( from, start + i, scaled, shared[i], i );
+			};
+			for ( std::size_t r = 0; ( r != dim ) && exact; ++r ) {
+				for ( std::size_t i = 0; i != count; ++i ) {
+					wide sum = (wide)coef[r][dim] * shared[i];
+					for ( std::size_t c = 0; c != dim; ++c ) {
+						sum += (wide)coef[r][c] * scaled[c][i];
+					};
+					sums[r][i] = sum;
+				};
+			};
+			for ( std::size_t r = 0; ( r != dim ) && !exact; ++r ) {
+				for ( std::size_t i = 0; i != count; ++i ) {
+					wide sum{};
+					bool over = __builtin_mul_overflow( (wide)coef[r][dim],
+														(wide)shared[i], &sum );
+					for ( std::size_t c = 0; c != dim; ++c ) {
+						wide product;
+						over |= __builtin_mul_overflow( (wide)coef[r][c],
+														(wide)scaled[c][i], &product );
+						over |= __builtin_add_overflow( sum, product, &sum );
+					};
+					sums[r][i] = sum;
+					overflow[i] |= over;
+				};
+			};
+			for ( std::size_t i = 0; i != count; ++i ) {
+				wide out_den{};
+				overflow[i] |= __builtin_mul_overflow( (wide)den, (wide)shared[i], &out_den );
+				for ( std::size_t r = 0; ( r != dim ) && !overflow[i]; ++r ) {
+					overflow[i] = !detail::narrow_reduced(
+						sums[r][i], out_den, to[r].num[start + i], to[r].den[start + i] );
+				};
+				if ( overflow[i] ) {
+					for ( auto &column : to ) {
+						column.num[start + i] = 0;
+						column.den[start + i] = 0;
+					};
+					++failed;
+				};
+			};
+		};
+		return failed;
+	};
+
+	// Map a single point.
+	[[nodiscard]] std::optional< std::array< fraction_type, dim > >
+	operator()( const std::array< fraction_type, dim > &p ) const {
+		points one;
+		for ( std::size_t c = 0; c != dim; ++c ) {
+			one[c].num.assign( 1, p[c].num() );
+			one[c].den.assign( 1, p[c].den() );
+		};
+		if ( apply( one, one ) != 0 ) {
+			return std::nullopt;
+		};
+		std::array< fraction_type, dim > result;
+		for ( std::size_t c = 0; c != dim; ++c ) {
+			result[c] = fraction_type::from_reduced( one[c].num[0], one[c].den[0] );
+		};
+		return result;
+	};
+
+	// The integer coefficients over denominator().
+	[[nodiscard]] INT coefficient( const std::size_t r,
+								   const std::size_t c ) const noexcept {
+		return coef[r][c];
+	};
+	[[nodiscard]] INT denominator() const noexcept { return den; };
+
+  private:
+	using wide = detail::widened_t< INT >;
+	using uwide = detail::widened_unsigned_t< wide >;
+	static constexpr std::size_t block = 256;
+
+	// The numerators of point i over a common denominator, false on overflow.
+	[[nodiscard]] static bool
+	scale( const points &from, const std::size_t i,
+		   std::array< std::array< INT, block >, dim > &scaled, INT &shared,
+		   const std::size_t at ) noexcept {
+		shared = from[0].den[i];
+		bool same = true;
+		for ( std::size_t c = 1; c != dim; ++c ) {
+			same &= ( from[c].den[i] == shared );
+		};
+		if ( !same ) {
+			for ( std::size_t c = 0; c != dim; ++c ) {
+				if ( from[c].den[i] == 0 ) {
+					return false;
+				};
+			};
+			for ( std::size_t c = 1; c != dim; ++c ) {
+				const INT d = from[c].den[i];
+				if ( shared % d != 0 ) {
+					const auto lcm =
+						detail::checked_mul( shared / std::gcd( shared, d ), d );
+					if ( !lcm ) {
+						return false;
+					};
+					shared = *lcm;
+				};
+			};
+		};
+		if ( shared == 0 ) {
+			return false;
+		};
+		for ( std::size_t c = 0; c != dim; ++c ) {
+			const auto n = same ? std::optional< INT >{ from[c].num[i] }
+								: detail::checked_mul( from[c].num[i],
+													   shared / from[c].den[i] );
+			if ( !n ) {
+				return false;
+			};
+			scaled[c][at] = *n;
+		};
+		return true;
+	};
+
+	std::array< std::array< INT, dim + 1 >, dim > coef{};
+	INT den = 1;
+	bool exact = true;
+}; // class affine
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+using affine2 = affine< INT, error_exp, 2 >;
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+using affine3 = affine< INT, error_exp, 3 >;
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * fraction_arrow.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Columns of fractions through the Arrow C data interface, to pass them to
+// and from columnar libraries exactly and without converting each value:
+//   to_arrow()     - a fraction_soa, or fractions, as an ArrowArray and
+//                    ArrowSchema
+//   arrow_column   - an imported ArrowArray, read in place
+// A column is an Arrow struct ("+s") of two non nullable integer children,
+// "num" and "den", of the width of INT ("l" for std::int64_t). Exporting a
+// fraction_soa moves its vectors into the array, so the values are not
+// copied, and importing reads the children's buffers where they are.
+// Exported values are as they are in the soa, so not necessarily reduced,
+// and imported ones are reduced as each fraction is read. A column never
+// has a 0 denominator: neither to_arrow() nor arrow_column::from_arrow()
+// takes one, so 1/0 cannot go out and fail to come back.
+// The interface is two C structs that every implementation defines the
+// same way, so there is no dependency on Arrow itself.
+
+#ifndef FRACTION_ARROW_HPP
+#define FRACTION_ARROW_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+// As specified by the Arrow C data interface.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+	// Array type description
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+
+	// Release callback
+	void ( *release )( struct ArrowSchema * );
+	// Opaque producer-specific data
+	void *private_data;
+};
+
+struct ArrowArray {
+	// Array data description
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+
+	// Release callback
+	void ( *release )( struct ArrowArray * );
+	// Opaque producer-specific data
+	void *private_data;
+};
+
+} // extern "C"
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace mth {
+
+// The integers Arrow has a signed type for.
+template< typename INT >
+concept arrow_integer = std::signed_integral< INT > && ( sizeof( INT ) <= 8 );
+
+namespace detail {
+
+template< arrow_integer INT > [[nodiscard]] constexpr const char *arrow_format() noexcept {
+	if constexpr ( sizeof( INT ) == 1 ) {
+		return "c";
+	} else if constexpr ( sizeof( INT ) == 2 ) {
+		return "s";
+	} else if constexpr ( sizeof( INT ) == 4 ) {
+		return "i";
+	} else {
+		return "l";
+	};
+};
+
+// What a child array owns: its values and the buffer pointers to them.
+template< arrow_integer INT > struct arrow_child {
+	std::vector< INT > values;
+	std::array< const void *, 2 > buffers{}; // validity (none), values
+};
+
+// What the struct array owns: the children, which release themselves.
+struct arrow_parent {
+	std::array< ArrowArray, 2 > children{};
+	std::array< ArrowArray *, 2 > child_pointers{};
+	std::array< const void *, 1 > buffers{}; // validity (none)
+};
+
+struct arrow_schema_parent {
+	std::array< ArrowSchema, 2 > children{};
+	std::array< ArrowSchema *, 2 > child_pointers{};
+};
+
+template< arrow_integer INT >
+void to_arrow( std::vector< INT > &&values, ArrowArray &to ) {
+	auto owner = std::make_unique< arrow_child< INT > >();
+	owner->values = std::move( values );
+	owner->buffers = { nullptr, owner->values.data() };
+	to = ArrowArray{};
+	to.length = (int64_t)owner->values.size();
+	to.n_buffers = 2;
+	to.buffers = owner->buffers.data();
+	to.release = []( ArrowArray *array ) {
+		delete static_cast< arrow_child< INT > * >( array->private_data );
+		array->release = nullptr;
+	};
+	to.private_data = owner.release();
+};
+
+inline void to_arrow_schema( const char *format, const char *name,
+							 ArrowSchema &to ) noexcept {
+	to = ArrowSchema{};
+	to.format = format;
+	to.name = name;
+	to.release = []( ArrowSchema *schema ) { schema->release = nullptr; };
+};
+
+// Nulls, a dictionary or a child that is not INT are not a column.
+template< arrow_integer INT >
+[[nodiscard]] bool is_arrow_column( const ArrowSchema &schema ) noexcept {
+	if ( ( schema.release == nullptr ) || ( std::strcmp( schema.format, "+s" ) != 0 ) ||
+		 ( schema.n_children != 2 ) || ( schema.dictionary != nullptr ) ) {
+		return false;
+	};
+	for ( std::size_t i = 0; i != 2; ++i ) {
+		const ArrowSchema &child = *schema.children[i];
+		if ( ( std::strcmp( child.format, arrow_format< INT >() ) != 0 ) ||
+			 ( child.dictionary != nullptr ) ) {
+			return false;
+		};
+	};
+	return true;
+};
+
+[[nodiscard]] inline bool has_nulls( const ArrowArray &array ) noexcept {
+	return ( array.n_buffers < 1 ) ||
+		   ( ( array.buffers[0] != nullptr ) && ( array.null_count != 0 ) );
+};
+
+}; // namespace detail
+
+// from as an Arrow struct of numerators and denominators, taking its
+// vectors rather than copying them. A den of one value, a shared
+// denominator as to_shared_denominator() gives, is repeated for each row.
+// array and schema are each released by their release callback. false,
+// leaving from, array and schema as they were, if den is neither one value
+// nor one per numerator, or if a denominator is 0.
+template< arrow_integer INT >
+[[nodiscard]] bool to_arrow( fraction_soa< INT > &&from, ArrowArray &array,
+							 ArrowSchema &schema ) {
+	if ( ( ( from.den.size() != from.num.size() ) && ( from.den.size() != 1 ) ) ||
+		 ( std::ranges::find( from.den, INT{ 0 } ) != from.den.end() ) ) {
+		return false;
+	};
+	if ( from.den.size() != from.num.size() ) {
+		from.den.assign( from.num.size(), from.den.front() );
+	};
+	const auto length = (int64_t)from.num.size();
+
+	auto schema_owner = std::make_unique< detail::arrow_schema_parent >();
+	detail::to_arrow_schema( detail::arrow_format< INT >(), "num",
+							 schema_owner->children[0] );
+	detail::to_arrow_schema( detail::arrow_format< INT >(), "den",
+							 schema_owner->children[1] );
+	schema_owner->child_pointers = { &schema_owner->children[0],
+									 &schema_owner->children[1] };
+
+	auto array_owner = std::make_unique< detail::arrow_parent >();
+	detail::to_arrow( std::move( from.num ), array_owner->children[0] );
+	try {
+		detail::to_arrow( std::move( from.den ), array_owner->children[1] );
+	} catch ( ... ) {
+		array_owner->children[0].release( &array_owner->children[0] );
+		throw;
+	};
+	array_owner->child_pointers = { &array_owner->children[0],
+									&array_owner->children[1] };
+
+	schema = ArrowSchema{};
+	schema.format = "+s";
+	schema.name = "";
+	schema.n_children = 2;
+	schema.children = schema_owner->child_pointers.data();
+	schema.release = []( ArrowSchema *s ) {
+		auto *owner = static_cast< detail::arrow_schema_parent * >( s->private_data );
+		for ( auto &child : owner->children ) {
+			if ( child.release != nullptr ) {
+				child.release( &child );
+			};
+		};
+		delete owner;
+		s->release = nullptr;
+	};
+	schema.private_data = schema_owner.release();
+
+	array = ArrowArray{};
+	array.length = length;
+	array.n_buffers = 1;
+	array.n_children = 2;
+	array.buffers = array_owner->buffers.data();
+	array.children = array_owner->child_pointers.data();
+	array.release = []( ArrowArray *a ) {
+		auto *owner = static_cast< detail::arrow_parent * >( a->private_data );
+		// A consumer may have moved a child out, leaving it released.
+		for ( auto &child : owner->children ) {
+			if ( child.release != nullptr ) {
+				child.release( &child );
+			};
+		};
+		delete owner;
+		a->release = nullptr;
+	};
+	array.private_data = array_owner.release();
+	return true;
+};
+
+// from as an Arrow struct, copied once into the numerator and denominator
+// arrays. false, leaving array and schema as they were, if any is 1/0.
+template< arrow_integer INT, int error_exp >
+[[nodiscard]] bool to_arrow( const std::span< const fraction< INT, error_exp > > from,
+							 ArrowArray &array, ArrowSchema &schema ) {
+	fraction_soa< INT > soa;
+	soa.resize( from.size() );
+	for ( std::size_t i = 0; i != from.size(); ++i ) {
+		soa.num[i] = from[i].num();
+		soa.den[i] = from[i].den();
+	};
+	return to_arrow( std::move( soa ), array, schema );
+};
+
+// A column of fractions in an Arrow struct array, read in place.
+template< arrow_integer INT = std::int64_t, int error_exp = -6 > class arrow_column {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+
+	// Takes array, leaving it released, if schema is a struct of two INT
+	// children without nulls and no denominator is 0. Otherwise nothing,
+	// and array is still the caller's to release.
+	[[nodiscard]] static std::optional< arrow_column >
+	from_arrow( ArrowArray &array, const ArrowSchema &schema ) noexcept {
+		if ( !detail::is_arrow_column< INT >( schema ) || ( array.release == nullptr ) ||
+			 ( array.n_children != 2 ) || detail::has_nulls( array ) ) {
+			return std::nullopt;
+		};
+		std::array< std::span< const INT >, 2 > values;
+		for ( std::size_t i = 0; i != 2; ++i ) {
+			const ArrowArray &child = *array.children[i];
+			if ( ( child.n_buffers != 2 ) || detail::has_nulls( child ) ||
+				 ( child.length < array.offset + array.length ) ) {
+				return std::nullopt;
+			};
+			if ( array.length != 0 ) {
+				values[i] = { static_cast< const INT * >( child.buffers[1] ) +
+								  child.offset + array.offset,
+							  (std::size_t)array.length };
+			};
+		};
+		if ( std::ranges::find( values[1], INT{ 0 } ) != values[1].end() ) {
+			return std::nullopt;
+		};
+		arrow_column result;
+		result.array = array;
+		result.nums = values[0];
+		result.dens = values[1];
+		array.release = nullptr;
+		return result;
+	};
+
+	arrow_column( arrow_column &&from ) noexcept
+		: array( from.array ), nums( from.nums ), dens( from.dens ) {
+		from.array.release = nullptr;
+	};
+	arrow_column &operator=( arrow_column &&from ) noexcept {
+		if ( this != &from ) {
+			release();
+			array = from.array;
+			nums = from.nums;
+			dens = from.dens;
+			from.array.release = nullptr;
+		};
+		return *this;
+	};
+	arrow_column( const arrow_column & ) = delete;
+	arrow_column &operator=( const arrow_column & ) = delete;
+	~arrow_column() { release(); };
+
+	[[nodiscard]] std::size_t size() const noexcept { return nums.size(); };
+	// The numerators and denominators as they are in the array.
+	[[nodiscard]] std::span< const INT > num() const noexcept { return nums; };
+	[[nodiscard]] std::span< const INT > den() const noexcept { return dens; };
+	[[nodiscard]] fraction_type operator[]( const std::size_t i ) const noexcept {
+		return fraction_type{ nums[i], dens[i] };
+	};
+
+	void decode( const std::span< fraction_type > to ) const noexcept {
+		const std::size_t n = std::min( to.size(), size() );
+		for ( std::size_t i = 0; i != n; ++i ) {
+			to[i] = ( *this )[i];
+		};
+	};
+	void decode( fraction_soa< INT > &to ) const {
+		to.num.assign( nums.begin(), nums.end() );
+		to.den.assign( dens.begin(), dens.end() );
+	};
+
+  private:
+	arrow_column() = default;
+
+	void release() noexcept {
+		if ( array.release != nullptr ) {
+			array.release( &array );
+		};
+	};
+
+	ArrowArray array{};
+	std::span< const INT > nums;
+	std::span< const INT > dens;
+}; // class arrow_column
+
+}; // namespace mth
+
+#endif
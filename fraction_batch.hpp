@@ -0,0 +1,308 @@
+/*
+ * fraction_batch.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Batch conversion and simplification across threads:
+//   to_fractions()   - fraction( double ) of each double, into fractions
+//                      or through a fraction_view
+//   simplify_sqrts() - simplify_sqrt() of each fraction, of a span or
+//                      through a fraction_view
+//   simplify_cbrts() - simplify_cbrt() of each fraction, likewise
+// The cost of each varies by orders of magnitude with the input (the Stern
+// Brocot search takes about 1 / x steps for a small x), so a fixed split
+// across threads can leave one thread with nearly all the work. Instead
+// parallel_for() balances the load by work stealing. The range is cut into
+// chunks of grain elements and each thread starts with an equal share,
+// held as one task in its own Chase-Lev deque. A thread repeatedly halves
+// its task, pushing the upper half onto the bottom of its deque, until one
+// chunk is left, which it runs before taking the last task it pushed. A
+// thread that runs out steals from the top of another's deque, where the
+// largest tasks are. See Chase and Lev, "Dynamic Circular Work-Stealing
+// Deque", and Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models", for the deque.
+
+#ifndef FRACTION_BATCH_HPP
+#define FRACTION_BATCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_view.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// A Chase-Lev work-stealing deque of 64 bit values. Only the owning thread
+// may push() and take(), at the bottom; any thread may steal() from the
+// top. It grows as needed, keeping the old arrays until it is destroyed as
+// a thief may still be reading one.
+class stealing_deque {
+  public:
+	explicit stealing_deque( const std::size_t capacity = 64 ) {
+		arrays.push_back( std::make_unique< ring >( std::bit_ceil( capacity ) ) );
+		array.store( arrays.back().get(), std::memory_order_relaxed );
+	};
+	stealing_deque( const stealing_deque & ) = delete;
+	stealing_deque &operator=( const stealing_deque & ) = delete;
+
+	void push( const std::uint64_t x ) {
+		const std::int64_t b = bottom.load( std::memory_order_relaxed );
+		const std::int64_t t = top.load( std::memory_order_acquire );
+		ring *a = array.load( std::memory_order_relaxed );
+		if ( b - t > (std::int64_t)a->mask ) {
+			arrays.push_back( std::make_unique< ring >( 2 * ( a->mask + 1 ) ) );
+			for ( std::int64_t i = t; i != b; ++i ) {
+				arrays.back()->put( i, a->get( i ) );
+			};
+			a = arrays.back().get();
+			array.store( a, std::memory_order_release );
+		};
+		a->put( b, x );
+		bottom.store( b + 1, std::memory_order_release );
+	};
+	[[nodiscard]] std::optional< std::uint64_t > take() noexcept {
+		const std::int64_t b = bottom.load( std::memory_order_relaxed ) - 1;
+		ring *const a = array.load( std::memory_order_relaxed );
+		// Both seq_cst, so a thief sees the claim on b before it reads bottom.
+		bottom.store( b, std::memory_order_seq_cst );
+		std::int64_t t = top.load( std::memory_order_seq_cst );
+		if ( t > b ) {
+			bottom.store( b + 1, std::memory_order_relaxed );
+			return std::nullopt;
+		};
+		const std::uint64_t x = a->get( b );
+		if ( t == b ) {
+			// The last one, race any thief for it.
+			const bool won = top.compare_exchange_strong(
+				t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+			bottom.store( b + 1, std::memory_order_relaxed );
+			return won ? std::optional{ x } : std::nullopt;
+		};
+		return x;
+	};
+	// Nothing if empty or another thread got there first.
+	[[nodiscard]] std::optional< std::uint64_t > steal() noexcept {
+		std::int64_t t = top.load( std::memory_order_seq_cst );
+		const std::int64_t b = bottom.load( std::memory_order_seq_cst );
+		if ( t >= b ) {
+			return std::nullopt;
+		};
+		const std::uint64_t x = array.load( std::memory_order_acquire )->get( t );
+		return top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst,
+											std::memory_order_relaxed )
+				   ? std::optional{ x }
+				   : std::nullopt;
+	};
+
+  private:
+	struct ring {
+		explicit ring( const std::size_t size )
+			: mask{ size - 1 }, items{ std::make_unique< std::atomic< std::uint64_t >[] >(
+									size ) } {};
+		[[nodiscard]] std::uint64_t get( const std::int64_t i ) const noexcept {
+			return items[(std::size_t)i & mask].load( std::memory_order_relaxed );
+		};
+		void put( const std::int64_t i, const std::uint64_t x ) noexcept {
+			items[(std::size_t)i & mask].store( x, std::memory_order_relaxed );
+		};
+
+		std::size_t mask;
+		std::unique_ptr< std::atomic< std::uint64_t >[] > items;
+	};
+
+	alignas( 64 ) std::atomic< std::int64_t > top{ 0 };
+	alignas( 64 ) std::atomic< std::int64_t > bottom{ 0 };
+	std::atomic< ring * > array{ nullptr };
+	std::vector< std::unique_ptr< ring > > arrays;
+}; // class stealing_deque
+
+}; // namespace detail
+
+// body( begin, end ) over [0, size) in pieces of at most grain, balanced
+// across threads by work stealing. body must not throw.
+template< typename BODY >
+void parallel_for( const std::size_t size, std::size_t grain, BODY body,
+				   std::size_t threads = std::thread::hardware_concurrency() ) {
+	// Tasks are chunk ranges [first, last), packed into 64 bits.
+	grain = std::max< std::size_t >( { grain, 1, size / 0xffffffff + 1 } );
+	const std::uint64_t chunks = ( size + grain - 1 ) / grain;
+	if ( chunks == 0 ) {
+		return;
+	};
+	threads = std::clamp< std::size_t >( threads, 1, chunks );
+	const auto pack = []( const std::uint64_t first, const std::uint64_t last ) {
+		return ( first << 32 ) | last;
+	};
+	std::vector< detail::stealing_deque > deques( threads );
+	for ( std::size_t i = 0; i != threads; ++i ) {
+		deques[i].push( pack( chunks * i / threads, chunks * ( i + 1 ) / threads ) );
+	};
+	std::atomic< std::uint64_t > remaining{ chunks };
+	const auto work = [&]( const std::size_t self ) {
+		for ( std::size_t victim = self; remaining.load() != 0; ) {
+			auto task = deques[self].take();
+			for ( std::size_t tries = 0; !task && ( tries != threads ); ++tries ) {
+				victim = ( victim + 1 ) % threads;
+				task = ( victim == self ) ? std::nullopt : deques[victim].steal();
+			};
+			if ( !task ) {
+				std::this_thread::yield();
+				continue;
+			};
+			std::uint64_t first = *task >> 32;
+			std::uint64_t last = *task & 0xffffffff;
+			for ( ; last - first > 1; last = ( first + last ) / 2 ) {
+				deques[self].push( pack( ( first + last ) / 2, last ) );
+			};
+			body( (std::size_t)first * grain,
+				  std::min( (std::size_t)last * grain, size ) );
+			remaining.fetch_sub( 1 );
+		};
+	};
+	std::vector< std::jthread > workers;
+	for ( std::size_t i = 1; i != threads; ++i ) {
+		workers.emplace_back( work, i );
+	};
+	work( 0 );
+};
+
+// fraction( double ) of each of from, to the same position in to.
+template< std::integral INT, int error_exp >
+void to_fractions( const std::span< const double > from,
+				   const std::span< fraction< INT, error_exp > > to,
+				   const std::size_t threads = std::thread::hardware_concurrency() ) {
+	parallel_for(
+		std::min( from.size(), to.size() ), 16,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = fraction< INT, error_exp >{ from[i] };
+			};
+		},
+		threads );
+};
+
+// fraction( double ) of each of from, stored in the numerators and
+// denominators to views.
+template< std::integral INT, int error_exp >
+	requires( !std::is_const_v< INT > )
+void to_fractions( const std::span< const double > from,
+				   const fraction_view< INT, error_exp > to,
+				   const std::size_t threads = std::thread::hardware_concurrency() ) {
+	parallel_for(
+		std::min( from.size(), to.size() ), 16,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = fraction< INT, error_exp >{ from[i] };
+			};
+		},
+		threads );
+};
+
+// simplify_sqrt() of each of from, to the same position in to.
+template< std::integral INT, int error_exp >
+void simplify_sqrts(
+	const std::span< const fraction< INT, error_exp > > from,
+	const std::span< std::pair< fraction< INT, error_exp >, fraction< INT, error_exp > > >
+		to,
+	const std::size_t threads = std::thread::hardware_concurrency() ) {
+	parallel_for(
+		std::min( from.size(), to.size() ), 64,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = from[i].simplify_sqrt();
+			};
+		},
+		threads );
+};
+
+// simplify_sqrt() of each of the fractions from views, to the same position
+// in to.
+template< typename INT, int error_exp >
+void simplify_sqrts(
+	const fraction_view< INT, error_exp > from,
+	const std::type_identity_t< std::span< std::pair<
+		fraction< std::remove_const_t< INT >, error_exp >,
+		fraction< std::remove_const_t< INT >, error_exp > > > >
+		to,
+	const std::size_t threads = std::thread::hardware_concurrency() ) {
+	using fraction_type = fraction< std::remove_const_t< INT >, error_exp >;
+	parallel_for(
+		std::min( from.size(), to.size() ), 64,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = fraction_type( from[i] ).simplify_sqrt();
+			};
+		},
+		threads );
+};
+
+// simplify_cbrt() of each of from, to the same position in to.
+template< std::integral INT, int error_exp >
+void simplify_cbrts(
+	const std::span< const fraction< INT, error_exp > > from,
+	const std::span< std::pair< fraction< INT, error_exp >, fraction< INT, error_exp > > >
+		to,
+	const std::size_t threads = std::thread::hardware_concurrency() ) {
+	parallel_for(
+		std::min( from.size(), to.size() ), 64,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = from[i].simplify_cbrt();
+			};
+		},
+		threads );
+};
+
+// simplify_cbrt() of each of the fractions from views, to the same position
+// in to.
+template< typename INT, int error_exp >
+void simplify_cbrts(
+	const fraction_view< INT, error_exp > from,
+	const std::type_identity_t< std::span< std::pair<
+		fraction< std::remove_const_t< INT >, error_exp >,
+		fraction< std::remove_const_t< INT >, error_exp > > > >
+		to,
+	const std::size_t threads = std::thread::hardware_concurrency() ) {
+	using fraction_type = fraction< std::remove_const_t< INT >, error_exp >;
+	parallel_for(
+		std::min( from.size(), to.size() ), 64,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				to[i] = fraction_type( from[i] ).simplify_cbrt();
+			};
+		},
+		threads );
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * fraction_bezier.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Rational (weighted) Bezier curves with fraction control points and
+// weights, evaluated and subdivided exactly by de Casteljau's algorithm.
+// Each control point p with weight w is held as the homogeneous integer
+// point ( w * p, w ) * D, with D the common denominator of all of them.
+// A curve point is the first dim coordinates over the last, so D, and any
+// other factor common to every control point, cancels.
+// At t = p/q each de Casteljau step is ( q - p ) * a + p * b, the lerp
+// times q. The result is q^n times the lerp, which also cancels, so every
+// level is integer multiplies and adds in widened integers, with no gcd
+// until the point is reduced at the end. At t = 1/2 it is just a + b.
+// split() brings each new control point to the common factor q^n, by
+// shifts when q is a power of 2, then removes the gcd of the whole curve.
+// Arithmetic that overflows gives nothing rather than a wrong result.
+
+#ifndef FRACTION_BEZIER_HPP
+#define FRACTION_BEZIER_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+template< std::integral INT = std::int64_t, int error_exp = -6, std::size_t dim = 2 >
+class bezier {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using point = std::array< fraction_type, dim >;
+	// One column per coordinate.
+	using points = std::array< fraction_soa< INT >, dim >;
+
+	// weights is empty (all 1) or one per control point. Nothing if there
+	// are no control points, a weight is 0 or the common denominator
+	// overflows INT.
+	[[nodiscard]] static std::optional< bezier >
+	from_points( const std::span< const point > control,
+				 const std::span< const fraction_type > weights = {} ) {
+		if ( control.empty() ||
+			 ( !weights.empty() && ( weights.size() != control.size() ) ) ) {
+			return std::nullopt;
+		};
+		std::vector< std::array< fraction_type, dim + 1 > > scaled( control.size() );
+		for ( std::size_t i = 0; i != control.size(); ++i ) {
+			const fraction_type w = weights.empty() ? fraction_type::f_1 : weights[i];
+			if ( w.num() == 0 ) {
+				return std::nullopt;
+			};
+			for ( std::size_t k = 0; k != dim; ++k ) {
+				scaled[i][k] = control[i][k] * w;
+			};
+			scaled[i][dim] = w;
+		};
+		INT den = 1;
+		for ( const auto &row : scaled ) {
+			for ( const auto &f : row ) {
+				if ( f.den() == 0 ) {
+					return std::nullopt;
+				};
+				if ( den % f.den() != 0 ) {
+					const auto lcm =
+						detail::checked_mul( den / std::gcd( den, f.den() ), f.den() );
+					if ( !lcm ) {
+						return std::nullopt;
+					};
+					den = *lcm;
+				};
+			};
+		};
+		bezier result;
+		result.hom.resize( scaled.size() );
+		for ( std::size_t i = 0; i != scaled.size(); ++i ) {
+			for ( std::size_t k = 0; k != dim + 1; ++k ) {
+				const auto h =
+					detail::checked_mul( scaled[i][k].num(), den / scaled[i][k].den() );
+				if ( !h ) {
+					return std::nullopt;
+				};
+				result.hom[i][k] = *h;
+			};
+		};
+		return result;
+	};
+
+	[[nodiscard]] std::size_t degree() const noexcept { return hom.size() - 1; };
+	[[nodiscard]] point control_point( const std::size_t i ) const noexcept {
+		point result;
+		for ( std::size_t k = 0; k != dim; ++k ) {
+			result[k] = fraction_type{ hom[i][k], hom[i][dim] };
+		};
+		return result;
+	};
+	// Weights are relative, only their ratios matter.
+	[[nodiscard]] fraction_type weight( const std::size_t i ) const noexcept {
+		return fraction_type{ hom[i][dim], hom[0][dim] };
+	};
+
+	// The point at t, nothing on overflow or at a point at infinity.
+	[[nodiscard]] std::optional< point >
+	operator()( const fraction_type &t ) const noexcept {
+		std::vector< std::array< wide, dim + 1 > > level( hom.size() );
+		if ( !de_casteljau( t, level ) ) {
+			return std::nullopt;
+		};
+		return project( level[0] );
+	};
+
+	// The points at each of ts. A point that overflows or is at infinity is
+	// set to 0/0. Returns the number of such points.
+	std::size_t evaluate( const std::span< const fraction_type > ts,
+						  points &to ) const {
+		for ( auto &column : to ) {
+			column.resize( ts.size() );
+		};
+		std::size_t failed = 0;
+		std::vector< std::array< wide, dim + 1 > > level( hom.size() );
+		for ( std::size_t j = 0; j != ts.size(); ++j ) {
+			std::optional< point > p;
+			if ( de_casteljau( ts[j], level ) ) {
+				p = project( level[0] );
+			};
+			for ( std::size_t k = 0; k != dim; ++k ) {
+				to[k].num[j] = p ? ( *p )[k].num() : 0;
+				to[k].den[j] = p ? ( *p )[k].den() : 0;
+			};
+			failed += p ? 0 : 1;
+		};
+		return failed;
+	};
+
+	// The curve split at t into the parts before and after t, each of the
+	// same degree. Nothing on overflow.
+	[[nodiscard]] std::optional< std::pair< bezier, bezier > >
+	split( const fraction_type &t ) const {
+		const std::size_t n = degree();
+		std::vector< std::array< wide, dim + 1 > > level( hom.size() );
+		// The left part is the first point of each level, the right part the
+		// last, in reverse.
+		std::vector< std::array< wide, dim + 1 > > left( n + 1 );
+		std::vector< std::array< wide, dim + 1 > > last( n + 1 );
+		if ( !de_casteljau( t, level, &left, &last ) ) {
+			return std::nullopt;
+		};
+		std::vector< std::array< wide, dim + 1 > > right( last.rbegin(),
+														  last.rend() );
+		// Bring every point to q^n.
+		const wide q = t.den();
+		const bool dyadic = std::has_single_bit( (std::make_unsigned_t< INT >)t.den() );
+		const auto scale_up = [&]( std::array< wide, dim + 1 > &h,
+								   const std::size_t times ) {
+			for ( auto &x : h ) {
+				for ( std::size_t i = 0; i != times; ++i ) {
+					if ( dyadic ? shift_overflows( x, t.den() )
+								: __builtin_mul_overflow( x, q, &x ) ) {
+						return false;
+					};
+				};
+			};
+			return true;
+		};
+		for ( std::size_t j = 0; j <= n; ++j ) {
+			if ( !scale_up( left[j], n - j ) || !scale_up( right[j], j ) ) {
+				return std::nullopt;
+			};
+		};
+		auto first = narrow( left );
+		auto second = narrow( right );
+		if ( !first || !second ) {
+			return std::nullopt;
+		};
+		return std::pair{ std::move( *first ), std::move( *second ) };
+	};
+
+  private:
+	using wide = detail::widened_t< INT >;
+	using uwide = detail::widened_unsigned_t< wide >;
+
+	// x <<= log2( den ), true on overflow.
+	[[nodiscard]] static bool shift_overflows( wide &x, const INT den ) noexcept {
+		const int bits = std::countr_zero( (std::make_unsigned_t< INT >)den );
+		const wide shifted = (wide)( (uwide)x << bits );
+		if ( ( shifted >> bits ) != x ) {
+			return true;
+		};
+		x = shifted;
+		return false;
+	};
+
+	// Run de Casteljau at t = p/q, leaving the curve point in level[0], times
+	// q^n. If given, first[r] and last[r] are set to the first and last
+	// points of level r, times q^r. false on overflow.
+	[[nodiscard]] bool
+	de_casteljau( const fraction_type &t,
+				  std::vector< std::array< wide, dim + 1 > > &level,
+				  std::vector< std::array< wide, dim + 1 > > *first = nullptr,
+				  std::vector< std::array< wide, dim + 1 > > *last =
+					  nullptr ) const noexcept {
+		if ( t.den() == 0 ) {
+			return false;
+		};
+		const wide p = t.num();
+		const wide q_p = (wide)t.den() - p;
+		const std::size_t n = degree();
+		for ( std::size_t i = 0; i <= n; ++i ) {
+			for ( std::size_t k = 0; k != dim + 1; ++k ) {
+				level[i][k] = hom[i][k];
+			};
+		};
+		bool over = false;
+		for ( std::size_t r = 0;; ++r ) {
+			if ( first != nullptr ) {
+				( *first )[r] = level[0];
+				( *last )[r] = level[n - r];
+			};
+			if ( r == n ) {
+				break;
+			};
+			for ( std::size_t i = 0; i + r != n; ++i ) {
+				for ( std::size_t k = 0; k != dim + 1; ++k ) {
+					wide a;
+					wide b;
+					over |= __builtin_mul_overflow( q_p, level[i][k], &a );
+					over |= __builtin_mul_overflow( p, level[i + 1][k], &b );
+					over |= __builtin_add_overflow( a, b, &level[i][k] );
+				};
+			};
+		};
+		return !over;
+	};
+
+	// The point h[0..dim) / h[dim], reduced.
+	[[nodiscard]] static std::optional< point >
+	project( std::array< wide, dim + 1 > h ) noexcept {
+		if ( h[dim] == 0 ) {
+			return std::nullopt;
+		};
+		if ( h[dim] < 0 ) {
+			for ( auto &x : h ) {
+				x = -x;
+			};
+		};
+		point result;
+		for ( std::size_t k = 0; k != dim; ++k ) {
+			INT num;
+			INT den;
+			if ( !detail::narrow_reduced( h[k], h[dim], num, den ) ) {
+				return std::nullopt;
+			};
+			result[k] = fraction_type::from_reduced( num, den );
+		};
+		return result;
+	};
+
+	// A curve from widened control points, less their common factor.
+	[[nodiscard]] static std::optional< bezier >
+	narrow( const std::vector< std::array< wide, dim + 1 > > &from ) noexcept {
+		uwide gcd = 0;
+		for ( const auto &h : from ) {
+			for ( const wide x : h ) {
+				gcd = detail::binary_gcd( gcd, ( x < 0 ) ? (uwide)0 - (uwide)x
+														 : (uwide)x );
+			};
+		};
+		bezier result;
+		result.hom.resize( from.size() );
+		for ( std::size_t i = 0; i != from.size(); ++i ) {
+			for ( std::size_t k = 0; k != dim + 1; ++k ) {
+				const wide x = from[i][k] / (wide)gcd;
+				result.hom[i][k] = (INT)x;
+				if ( result.hom[i][k] != x ) {
+					return std::nullopt;
+				};
+			};
+		};
+		return result;
+	};
+
+	// Homogeneous control points ( w * p, w ) over the common denominator.
+	std::vector< std::array< INT, dim + 1 > > hom;
+}; // class bezier
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,366 @@
+/*
+ * fraction_column.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Compressed encodings for columns of fractions:
+//   dictionary_column - distinct values plus bit packed codes, for columns
+//                       with few distinct values.
+//   for_column        - numerators over a shared denominator stored as
+//                       bit packed offsets from the smallest (frame of
+//                       reference).
+//   delta_column      - numerators over a shared denominator stored as bit
+//                       packed differences, for sorted columns.
+// Each can decode into fractions or into a fraction_soa (struct of arrays).
+// The shared denominator encodings decode to the soa without any gcd, the
+// numerators are then relative to the shared (unreduced) denominator.
+// The unpack loops are branch free so the compiler can vectorise them.
+
+#ifndef FRACTION_COLUMN_HPP
+#define FRACTION_COLUMN_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+// Numerators and denominators held in separate arrays.
+template< std::integral INT = std::int64_t > struct fraction_soa {
+	std::vector< INT > num;
+	std::vector< INT > den;
+
+	[[nodiscard]] std::size_t size() const noexcept { return num.size(); };
+	void resize( const std::size_t size ) {
+		num.resize( size );
+		den.resize( size );
+	};
+};
+
+namespace detail {
+
+// Bits needed to hold every value up to and including max.
+[[nodiscard]] constexpr unsigned bits_needed( const std::uint64_t max ) noexcept {
+	return (unsigned)std::bit_width( max );
+};
+
+// Pack values into width bits each. One extra word is kept at the end so
+// unpack() can always read the following word.
+[[nodiscard]] inline std::vector< std::uint64_t >
+pack( const std::span< const std::uint64_t > from, const unsigned width ) {
+	std::vector< std::uint64_t > words( ( from.size() * width + 63 ) / 64 + 1,
+										0 );
+	if ( width != 0 ) {
+		for ( std::size_t i = 0; i != from.size(); ++i ) {
+			const std::size_t bit = i * width;
+			const unsigned shift = (unsigned)( bit & 63 );
+			words[bit >> 6] |= from[i] << shift;
+			if ( shift + width > 64 ) {
+				words[( bit >> 6 ) + 1] |= from[i] >> ( 64 - shift );
+			};
+		};
+	};
+	return words;
+};
+
+// Inverse of pack(), writes to.size() values.
+inline void unpack( const std::span< const std::uint64_t > words,
+					const unsigned width,
+					const std::span< std::uint64_t > to ) noexcept {
+	if ( width == 0 ) {
+		std::ranges::fill( to, 0 );
+		return;
+	};
+	const std::uint64_t mask =
+		( width == 64 ) ? ~std::uint64_t{ 0 } : ( std::uint64_t{ 1 } << width ) - 1;
+	for ( std::size_t i = 0; i != to.size(); ++i ) {
+		const std::size_t bit = i * width;
+		const unsigned shift = (unsigned)( bit & 63 );
+		// Two shifts so a shift of 0 does not become an undefined shift of 64.
+		const std::uint64_t high = ( words[( bit >> 6 ) + 1] << 1 )
+								   << ( 63 - shift );
+		to[i] = ( ( words[bit >> 6] >> shift ) | high ) & mask;
+	};
+};
+
+// a * b, or nothing on overflow.
+template< std::integral INT >
+[[nodiscard]] constexpr std::optional< INT > checked_mul( const INT a,
+														  const INT b ) noexcept {
+	INT result{};
+	if ( __builtin_mul_overflow( a, b, &result ) ) {
+		return std::nullopt;
+	};
+	return result;
+};
+
+// A hash of a numerator and denominator together, for the hash tables of
+// fractions here and in fraction_pool.
+template< std::integral INT >
+[[nodiscard]] std::size_t hash_fraction( const INT num, const INT den ) noexcept {
+	const std::size_t h = std::hash< INT >{}( num );
+	return h ^ ( std::hash< INT >{}( den ) + 0x9e3779b97f4a7c15ULL + ( h << 6 ) + ( h >> 2 ) );
+};
+
+// Lowest common denominator of a column and the numerators scaled to it.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< fraction_soa< INT > >
+to_shared_denominator( const std::span< const fraction< INT, error_exp > > from ) {
+	INT den = 1;
+	for ( const auto &f : from ) {
+		if ( f.den() == 0 ) {
+			return std::nullopt;
+		};
+		if ( den % f.den() != 0 ) {
+			const auto lcm = checked_mul( den / std::gcd( den, f.den() ), f.den() );
+			if ( !lcm ) {
+				return std::nullopt;
+			};
+			den = *lcm;
+		};
+	};
+	fraction_soa< INT > result;
+	result.num.reserve( from.size() );
+	for ( const auto &f : from ) {
+		const auto num = checked_mul( f.num(), den / f.den() );
+		if ( !num ) {
+			return std::nullopt;
+		};
+		result.num.push_back( *num );
+	};
+	result.den.assign( 1, den );
+	return result;
+};
+
+}; // namespace detail
+
+// Dictionary encoding: each row is a code into a table of distinct values.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class dictionary_column {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+
+	[[nodiscard]] static dictionary_column
+	encode( const std::span< const fraction_type > from ) {
+		dictionary_column result;
+		std::unordered_map< fraction_type, std::uint64_t, hash > codes;
+		std::vector< std::uint64_t > row_codes;
+		row_codes.reserve( from.size() );
+		for ( const auto &f : from ) {
+			const auto [it, added] = codes.try_emplace( f, result.dict.size() );
+			if ( added ) {
+				result.dict.push_back( f );
+			};
+			row_codes.push_back( it->second );
+		};
+		result.rows = from.size();
+		result.width = detail::bits_needed(
+			result.dict.empty() ? 0 : result.dict.size() - 1 );
+		result.packed = detail::pack( row_codes, result.width );
+		return result;
+	};
+
+	void decode( const std::span< fraction_type > to ) const {
+		std::vector< std::uint64_t > row_codes( std::min( to.size(), rows ) );
+		detail::unpack( packed, width, row_codes );
+		for ( std::size_t i = 0; i != row_codes.size(); ++i ) {
+			to[i] = dict[row_codes[i]];
+		};
+	};
+	void decode( fraction_soa< INT > &to ) const {
+		std::vector< std::uint64_t > row_codes( rows );
+		detail::unpack( packed, width, row_codes );
+		to.resize( rows );
+		for ( std::size_t i = 0; i != rows; ++i ) {
+			to.num[i] = dict[row_codes[i]].num();
+			to.den[i] = dict[row_codes[i]].den();
+		};
+	};
+
+	[[nodiscard]] std::size_t size() const noexcept { return rows; };
+	[[nodiscard]] std::span< const fraction_type > dictionary() const noexcept {
+		return dict;
+	};
+	[[nodiscard]] std::size_t size_in_bytes() const noexcept {
+		return dict.size() * sizeof( INT ) * 2 +
+			   packed.size() * sizeof( std::uint64_t );
+	};
+
+  private:
+	struct hash {
+		std::size_t operator()( const fraction_type &f ) const noexcept {
+			return detail::hash_fraction( f.num(), f.den() );
+		};
+	};
+
+	std::vector< fraction_type > dict;
+	std::vector< std::uint64_t > packed;
+	std::size_t rows = 0;
+	unsigned width = 0;
+}; // class dictionary_column
+
+// Frame of reference encoding: numerators over a shared denominator stored
+// as offsets from the smallest numerator.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class for_column {
+	static_assert( sizeof( INT ) <= sizeof( std::uint64_t ) );
+	using UINT = std::make_unsigned_t< INT >;
+
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+
+	// Nothing if a denominator is 0 or the shared denominator overflows INT.
+	[[nodiscard]] static std::optional< for_column >
+	encode( const std::span< const fraction_type > from ) {
+		auto shared = detail::to_shared_denominator( from );
+		if ( !shared ) {
+			return std::nullopt;
+		};
+		for_column result;
+		result.rows = from.size();
+		result.den = shared->den[0];
+		result.reference =
+			from.empty() ? 0 : *std::ranges::min_element( shared->num );
+		std::vector< std::uint64_t > offsets( from.size() );
+		std::uint64_t max = 0;
+		for ( std::size_t i = 0; i != offsets.size(); ++i ) {
+			offsets[i] = (UINT)( (UINT)shared->num[i] - (UINT)result.reference );
+			max = std::max( max, offsets[i] );
+		};
+		result.width = detail::bits_needed( max );
+		result.packed = detail::pack( offsets, result.width );
+		return result;
+	};
+
+	void decode( const std::span< fraction_type > to ) const {
+		std::vector< std::uint64_t > offsets( std::min( to.size(), rows ) );
+		detail::unpack( packed, width, offsets );
+		for ( std::size_t i = 0; i != offsets.size(); ++i ) {
+			to[i] = fraction_type{ value( offsets[i] ), den };
+		};
+	};
+	// Numerators over the shared denominator, no gcd is taken.
+	void decode( fraction_soa< INT > &to ) const {
+		std::vector< std::uint64_t > offsets( rows );
+		detail::unpack( packed, width, offsets );
+		to.resize( rows );
+		for ( std::size_t i = 0; i != rows; ++i ) {
+			to.num[i] = value( offsets[i] );
+		};
+		std::ranges::fill( to.den, den );
+	};
+
+	[[nodiscard]] std::size_t size() const noexcept { return rows; };
+	[[nodiscard]] INT denominator() const noexcept { return den; };
+	[[nodiscard]] std::size_t size_in_bytes() const noexcept {
+		return sizeof( INT ) * 2 + packed.size() * sizeof( std::uint64_t );
+	};
+
+  private:
+	[[nodiscard]] INT value( const std::uint64_t offset ) const noexcept {
+		return (INT)( (UINT)reference + (UINT)offset );
+	};
+
+	std::vector< std::uint64_t > packed;
+	std::size_t rows = 0;
+	INT den = 1;
+	INT reference = 0;
+	unsigned width = 0;
+}; // class for_column
+
+// Delta encoding: numerators over a shared denominator stored as the
+// differences between neighbouring rows. The column must be sorted.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class delta_column {
+	static_assert( sizeof( INT ) <= sizeof( std::uint64_t ) );
+	using UINT = std::make_unsigned_t< INT >;
+
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+
+	// Nothing if the column is not in ascending order, a denominator is 0
+	// or the shared denominator overflows INT.
+	[[nodiscard]] static std::optional< delta_column >
+	encode( const std::span< const fraction_type > from ) {
+		auto shared = detail::to_shared_denominator( from );
+		if ( !shared || !std::ranges::is_sorted( shared->num ) ) {
+			return std::nullopt;
+		};
+		delta_column result;
+		result.rows = from.size();
+		result.den = shared->den[0];
+		result.first = from.empty() ? 0 : shared->num[0];
+		std::vector< std::uint64_t > deltas( from.size() );
+		std::uint64_t max = 0;
+		for ( std::size_t i = 1; i < deltas.size(); ++i ) {
+			deltas[i] =
+				(UINT)( (UINT)shared->num[i] - (UINT)shared->num[i - 1] );
+			max = std::max( max, deltas[i] );
+		};
+		result.width = detail::bits_needed( max );
+		result.packed = detail::pack( deltas, result.width );
+		return result;
+	};
+
+	void decode( const std::span< fraction_type > to ) const {
+		fraction_soa< INT > soa;
+		decode( soa );
+		const std::size_t size = std::min( to.size(), rows );
+		for ( std::size_t i = 0; i != size; ++i ) {
+			to[i] = fraction_type{ soa.num[i], den };
+		};
+	};
+	// Numerators over the shared denominator, no gcd is taken.
+	void decode( fraction_soa< INT > &to ) const {
+		std::vector< std::uint64_t > values( rows );
+		detail::unpack( packed, width, values );
+		to.resize( rows );
+		UINT sum = (UINT)first;
+		for ( std::size_t i = 0; i != rows; ++i ) {
+			sum = (UINT)( sum + (UINT)values[i] );
+			to.num[i] = (INT)sum;
+		};
+		std::ranges::fill( to.den, den );
+	};
+
+	[[nodiscard]] std::size_t size() const noexcept { return rows; };
+	[[nodiscard]] INT denominator() const noexcept { return den; };
+	[[nodiscard]] std::size_t size_in_bytes() const noexcept {
+		return sizeof( INT ) * 2 + packed.size() * sizeof( std::uint64_t );
+	};
+
+  private:
+	std::vector< std::uint64_t > packed;
+	std::size_t rows = 0;
+	INT den = 1;
+	INT first = 0;
+	unsigned width = 0;
+}; // class delta_column
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * fraction_complex.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Powers and roots of fractions as complex numbers, each part approximated
+// as a fraction. Kept apart from fraction_core.hpp for <complex>.
+
+#ifndef FRACTION_COMPLEX_HPP
+#define FRACTION_COMPLEX_HPP
+
+#include <complex>
+#include <utility>
+
+#include "fraction_core.hpp"
+
+FRACTION_EXPORT namespace mth {
+
+template< std::integral INT, int error_exp >
+std::pair< fraction< INT, error_exp >, fraction< INT, error_exp > >
+fraction< INT, error_exp >::pow_c( double exp ) const noexcept {
+	std::pair< fraction, fraction > result;
+	if ( ( ( exp < 0 ) && ( numerator == 0 ) ) ||
+		 ( ( exp >= 0 ) && ( denominator == 0 ) ) ) {
+		result = std::make_pair( f_inf, f_0 );
+	} else {
+		const std::complex< double > pow_d =
+			std::pow( std::complex< double >{ to_double(), 0.0 }, exp );
+		result = std::make_pair(
+			to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+				pow_d.real() ),
+			to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+				pow_d.imag() ) );
+	};
+	return result;
+};
+
+template< std::integral INT, int error_exp >
+std::pair< fraction< INT, error_exp >, fraction< INT, error_exp > >
+fraction< INT, error_exp >::sqrt_c() const noexcept {
+	std::pair< fraction, fraction > result;
+	if ( denominator == 0 ) {
+		result = std::make_pair( *this, f_0 );
+	} else {
+		const std::complex< double > sqrt_d{ std::sqrt(
+			std::complex< double >{ to_double(), 0.0 } ) };
+		result = std::make_pair(
+			to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+				sqrt_d.real() ),
+			to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+				sqrt_d.imag() ) );
+	};
+	return result;
+};
+
+}; // namespace mth
+
+#endif
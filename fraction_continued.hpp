@@ -0,0 +1,116 @@
+/*
+ * fraction_continued.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Continued fractions: a double to its continued fraction terms, the terms
+// to a fraction, the two together as a converter, and the terms as text.
+
+#ifndef FRACTION_CONTINUED_HPP
+#define FRACTION_CONTINUED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <string>
+
+#include "fraction_core.hpp"
+
+FRACTION_EXPORT namespace mth {
+
+namespace detail {
+
+// The continued fraction terms of num into to, until the remainder is
+// within error or to is full. true if within error. The terms taken are
+// added to *terms if given.
+template< std::integral INT, int error_exp >
+constexpr bool continued_fraction_terms( const double num, const std::span< INT > to,
+										 std::size_t *const terms = nullptr ) noexcept {
+	bool within = false;
+	std::size_t term = 0;
+	double remainder = num;
+	double iptr;
+	for ( auto it = to.begin(); it != to.end(); ++it, remainder = 1.0 / remainder ) {
+		++term;
+		remainder = std::modf( remainder, &iptr );
+		*it = (INT)iptr;
+		if ( std::abs( remainder ) < fraction< INT, error_exp >::error ) {
+			within = true;
+			break;
+		};
+	};
+	if ( terms != nullptr ) {
+		*terms += term;
+	};
+	return within;
+};
+
+}; // namespace detail
+
+template< std::size_t continued_fraction_max_iter = 25,
+		  std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] constexpr std::array< INT, continued_fraction_max_iter >
+to_continued_fraction( const double num ) noexcept {
+	std::array< INT, continued_fraction_max_iter > result{ 0 };
+	detail::continued_fraction_terms< INT, error_exp >( num, std::span< INT >{ result } );
+	return result;
+};
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] constexpr fraction< INT, error_exp >
+to_fraction( const std::span< INT > &from ) noexcept {
+	return std::accumulate( std::next( from.rbegin() ), from.rend(),
+							fraction< INT, error_exp >::f_0,
+							[]( fraction< INT, error_exp > a, INT b ) {
+								return ( a.num() == 0 ) ? fraction{ b }
+														: a.inv() + b;
+							} );
+};
+
+template< std::size_t continued_fraction_max_iter = 25,
+		  std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] constexpr fraction< INT, error_exp >
+to_fraction_using_continued_fractions( const double num ) noexcept {
+	auto cf{ to_continued_fraction< continued_fraction_max_iter, INT, error_exp >( num ) };
+	return to_fraction( std::span< INT >{ cf } );
+};
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] std::string to_string( const auto &cf ) noexcept {
+	const auto last =
+		std::ranges::find_if( cf.rbegin(), std::prev( cf.rend() ),
+							  []( auto val ) { return val != 0; } )
+			.base();
+	return std::accumulate(
+		std::next( cf.begin() ), last, std::to_string( cf[0] ),
+		[]( std::string result, int val ) {
+			return std::move( result ) + ',' + std::to_string( val );
+		} );
+	//~ return std::string_view{std::next( cf.begin()
+	//),last}|std::views::join_with(' ');
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,730 @@
+/*
+ * fraction_core.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// The fraction class with its arithmetic, comparisons and conversion from
+// double, without the heavier standard headers. Declared here but defined
+// in the extension headers, which fraction.hpp includes along with this:
+//   fraction_io.hpp         - to_chars(), to_string() and <<
+//   fraction_complex.hpp    - pow_c() and sqrt_c()
+//   fraction_continued.hpp  - continued fractions
+//   fraction_root_cache.hpp - the cache behind simplify_sqrt() and
+//                             simplify_cbrt()
+// Where FRACTION_EXTERN_TEMPLATES is defined, fraction< std::int32_t >,
+// fraction< std::int64_t > and (with GNU extensions) fraction< __int128 >
+// are declared extern, so each translation unit takes them, and the
+// extension members, from fraction.cpp rather than instantiating its own.
+
+#ifndef FRACTION_CORE_HPP
+#define FRACTION_CORE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <iosfwd> // std::string, declared only
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+// export when included by the mth.fraction module, fraction.cppm,
+// otherwise nothing.
+#ifndef FRACTION_EXPORT
+#define FRACTION_EXPORT
+#endif
+
+FRACTION_EXPORT namespace mth {
+
+// Forward declarations.
+template< std::integral INT = std::int64_t, int error_exp = -6 > class fraction;
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] constexpr fraction< INT, error_exp >
+to_fraction_using_stern_brocot_with_mediants( const double from ) noexcept;
+
+// remove when clang thinks std::pow is constexpr
+[[nodiscard]] constexpr double pow10( const int x ) noexcept {
+	const double base = 10.0; 
+	double result = 1.0;
+	if ( x < 0 ) {
+		for ( int i = 0; i > x; --i ) {
+			result /= base;
+		}
+	} else {
+		for ( int i = 0; i < x; ++i ) {
+			result *= base;
+		}
+	};
+	return result;
+};
+
+namespace detail {
+
+// abs(i) without overflow for the most negative INT.
+template< std::integral INT >
+[[nodiscard]] constexpr std::make_unsigned_t< INT > uabs( const INT i ) noexcept {
+	using U = std::make_unsigned_t< INT >;
+	return ( i < 0 ) ? (U)( U{ 0 } - (U)i ) : (U)i;
+};
+
+// A signed integer with twice the bits of INT, where the compiler has one,
+// and a 128 bit unsigned integer.
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+template< std::integral INT >
+using widened_t = std::conditional_t<
+	( sizeof( INT ) <= 4 ), std::int64_t,
+	std::conditional_t< ( sizeof( INT ) <= 8 ), int128_t, INT > >;
+
+template< typename W > struct widened_unsigned {
+	using type = std::make_unsigned_t< W >;
+};
+template<> struct widened_unsigned< int128_t > {
+	using type = uint128_t;
+};
+template< typename W >
+using widened_unsigned_t = typename widened_unsigned< W >::type;
+
+// Binary gcd, for the widened types that std::gcd does not take.
+template< typename U > [[nodiscard]] constexpr U binary_gcd( U a, U b ) noexcept {
+	if ( a == 0 ) {
+		return b;
+	};
+	if ( b == 0 ) {
+		return a;
+	};
+	unsigned shift = 0;
+	for ( ; ( ( a | b ) & 1 ) == 0; ++shift ) {
+		a >>= 1;
+		b >>= 1;
+	};
+	while ( ( a & 1 ) == 0 ) {
+		a >>= 1;
+	};
+	do {
+		while ( ( b & 1 ) == 0 ) {
+			b >>= 1;
+		};
+		if ( a > b ) {
+			std::swap( a, b );
+		};
+		b -= a;
+	} while ( b != 0 );
+	return a << shift;
+};
+
+
+// num / den in lowest terms as INTs, where num and den are widened and
+// den > 0. false if it does not fit.
+template< std::integral INT, typename W >
+[[nodiscard]] constexpr bool narrow_reduced( const W num, const W den, INT &to_num,
+											 INT &to_den ) noexcept {
+	using U = widened_unsigned_t< W >;
+	const U abs_num = ( num < 0 ) ? (U)0 - (U)num : (U)num;
+	const W gcd = (W)binary_gcd( abs_num, (U)den );
+	const W n = num / gcd;
+	const W d = den / gcd;
+	to_num = (INT)n;
+	to_den = (INT)d;
+	return ( to_num == n ) && ( to_den == d );
+};
+
+// floor(sqrt(n)), exact. Newton steps from an estimate that is then
+// corrected in integers.
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr U isqrt( const U n ) noexcept {
+	U r = std::is_constant_evaluated() ? n : (U)std::sqrt( (double)n );
+	while ( ( r != 0 ) && ( r > n / r ) ) {
+		r -= std::max< U >( ( r - n / r ) / 2, 1 );
+	};
+	while ( r + 1 <= n / ( r + 1 ) ) {
+		++r;
+	};
+	return r;
+};
+
+}; // namespace detail
+
+// Square and cube parts of an integer i, with the largest factors such that
+//   i == sq_factor^2 * sq_free == cb_factor^3 * cb_free.
+template< std::integral INT > struct root_parts {
+	INT sq_factor;
+	INT sq_free;
+	INT cb_factor;
+	INT cb_free;
+};
+
+// Factorise i to find its square and cube parts. Trial division only goes
+// up to cbrt(abs(i)), what is left is 1, a prime, the product of two primes
+// or the square of a prime so it only needs a square test.
+template< std::integral INT >
+[[nodiscard]] constexpr root_parts< INT > to_root_parts( const INT i ) noexcept {
+	using U = std::make_unsigned_t< INT >;
+	U remain = detail::uabs( i );
+	U sq = 1;
+	U cb = 1;
+	for ( U p = 2; ( remain != 0 ) && ( p <= remain / p / p );
+		  p += ( p == 2 ) ? 1 : 2 ) {
+		for ( unsigned e = 1; remain % p == 0; ++e ) {
+			remain /= p;
+			sq *= ( e % 2 == 0 ) ? p : 1;
+			cb *= ( e % 3 == 0 ) ? p : 1;
+		};
+	};
+	if ( const U r = detail::isqrt( remain ); ( r > 1 ) && ( r * r == remain ) ) {
+		sq *= r;
+	};
+	return { (INT)sq, i / (INT)( sq * sq ), (INT)cb, i / (INT)( cb * cb * cb ) };
+};
+
+namespace detail {
+
+// to_root_parts() through the root_cache, defined in fraction_root_cache.hpp.
+template< std::integral INT >
+[[nodiscard]] root_parts< INT > cached_root_parts( INT i ) noexcept;
+
+}; // namespace detail
+
+template< std::integral INT, int error_exp > class fraction {
+  public:
+	// Useful constants:
+	static const fraction f_0;	 //{ 0, 1 };
+	static const fraction f_1;	 //{ 1, 1 };
+	static const fraction f_inf; //{ 1, 0 };
+
+	// Constructors:
+	constexpr fraction() noexcept { *this = f_0; }; // set( 0, 1 ); };
+	constexpr fraction( const INT num, const INT den ) noexcept {
+		set( num, den );
+	};
+	constexpr fraction( const fraction &from ) = default;
+	constexpr fraction( fraction &&from ) = default;
+
+	constexpr explicit fraction( const INT num ) noexcept { set( num, 1 ); };
+	constexpr explicit fraction( const double from ) noexcept {
+		*this = to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+			from );
+	};
+	// Construct from a numerator and denominator already in lowest terms with
+	// a positive denominator, skipping the gcd in set().
+	[[nodiscard]] static constexpr fraction from_reduced( const INT num,
+														  const INT den ) noexcept {
+		return fraction{ num, den, reduced{} };
+	};
+
+	// Numerator and denominator get methods:
+	constexpr INT num() const noexcept { return numerator; };
+	constexpr INT den() const noexcept { return denominator; };
+
+	// Conversions:
+	// fraction to double.
+	constexpr double to_double() const noexcept {
+		return (double)numerator / (double)denominator;
+	};
+
+	// Accuracy to use when approximating a double with a fraction.
+	constexpr static const double error = pow10( error_exp );
+	// std::pow( 10.0, (double)error_exp ); // as not constexpr in clang
+
+	// Use stern brocot algorithm to approximate a double with a fraction.
+	friend constexpr fraction
+	to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+		const double from ) noexcept;
+
+	// Boolean operations:
+	// Check if fraction has denominator == 1.
+	[[nodiscard]] constexpr bool is_int() const noexcept {
+		return denominator == 1;
+	};
+	// Check if negative. Constructors move "-" sign to numerator.
+	[[nodiscard]] constexpr bool is_neg() const noexcept {
+		return numerator < 0;
+	};
+
+	// Maths:
+	// As per std::labs.
+	[[nodiscard]] constexpr fraction abs() const noexcept {
+		return { ( numerator < 0 ) ? -numerator : numerator, denominator };
+	};
+	// 1/fraction.
+	[[nodiscard]] constexpr fraction inv() const noexcept {
+		return { denominator, numerator };
+	};
+	// Calculate the mediant of two fractions.
+	[[nodiscard]] friend constexpr fraction
+	mediant( const fraction &f1, const fraction &f2 ) noexcept {
+		return fraction{ f1.num() + f2.num(), f1.den() + f2.den() };
+	};
+	// Decomposes fraction into integral and fractional parts like std::modf
+	[[nodiscard]] constexpr std::pair< double, fraction > modf() const noexcept {
+		std::pair< double, fraction > result;
+		if ( denominator == 0 ) {
+			result = std::make_pair( 0, *this );
+		} else {
+			double iptr = 0;
+			[[maybe_unused]] double fr = std::modf( to_double(), &iptr );
+			result = std::make_pair( (INT)iptr, *this - (INT)iptr );
+		};
+		return result;
+	};
+	// Calculate the average of some fractions.
+	template< typename... T >
+	[[nodiscard]] constexpr friend fraction
+	average( const T... fractions ) noexcept {
+		const std::size_t size{ sizeof...( fractions ) };
+		return ( size == 0 ) ? f_0 : ( fractions + ... ) / (INT)size;
+	}
+
+	// Exponentiation:
+	// Raise to the power of exp and approximate as a complex fraction, in
+	// fraction_complex.hpp.
+	[[nodiscard]] std::pair< fraction, fraction >
+	pow_c( double exp ) const noexcept;
+	// Raise to the power of exp and approximate as a fraction.
+	// Note: for negatives, pow(-N, 0.5) results in 0, ie the real part.
+	[[nodiscard]] constexpr fraction pow( double exp ) const noexcept {
+		return ( ( ( exp < 0 ) && ( numerator == 0 ) ) ||
+				 ( ( exp >= 0 ) && ( denominator == 0 ) ) )
+				   ? *this
+				   : to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+						 std::pow( to_double(), exp ) );
+	};
+	// Square a fraction.
+	[[nodiscard]] constexpr fraction sq() const noexcept {
+		return ( *this ) * ( *this );
+	};
+	// Determine if abs(fraction) is a perfect square.
+	[[nodiscard]] constexpr bool is_abs_sq() const noexcept {
+		const fraction sqrt_INT{ (INT)std::sqrt( (double)detail::uabs( numerator ) ),
+								 (INT)std::sqrt( denominator ) };
+		return abs() == sqrt_INT * sqrt_INT;
+	};
+	// Cube a fraction.
+	[[nodiscard]] constexpr fraction cb() const noexcept {
+		return ( *this ) * ( *this ) * ( *this );
+	};
+	// Determine if this fraction is a perfect cube.
+	[[nodiscard]] constexpr bool is_cb() const noexcept {
+		const fraction cbrt_INT{ (INT)std::cbrt( numerator ),
+								 (INT)std::cbrt( denominator ) };
+		return *this == cbrt_INT * cbrt_INT * cbrt_INT;
+	};
+	// Normalized fraction (range (-1, -0.5], [0.5, 1) ) and integral power of 2
+	// as per std::frexp() with the normalized fraction approximated as a
+	// fraction. e.g. (48/7) i.e. 6*(2^3)/7 => {(6/7), 3}
+	// 				  (1/4)                 => {(1/2), -1}
+	[[nodiscard]] constexpr std::pair< fraction, int > frexp() const noexcept {
+		int exp = 0;
+		fraction fr = ( denominator == 0 )
+						   ? *this
+						   : fraction{ std::frexp( to_double(), &exp ) };
+		return std::make_pair( fr, exp );
+	};
+	// Call load exponent as per std::ldexp() approximated as a fraction.
+	// e.g (2/5).ldexp(3) i.e. (2/5)*2^3 => (16/5)
+	[[nodiscard]] constexpr fraction ldexp( int exp ) const noexcept {
+		return ( denominator == 0 )
+				   ? *this
+				   : fraction{ std::ldexp( to_double(), exp ) };
+	};
+	// Calculate sqrt of a fraction and approximate it as a complex fraction,
+	// in fraction_complex.hpp.
+	[[nodiscard]] std::pair< fraction, fraction >
+	sqrt_c() const noexcept;
+	// Calculate sqrt of a fraction and approximate it as a fraction.
+	// Note: for negatives, sqrt(-N) results in 0, ie the real part.
+	[[nodiscard]] constexpr fraction sqrt() const noexcept {
+		return ( denominator == 0 )
+				   ? *this
+				   : to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+						 std::sqrt( to_double() ) );
+	};
+	// Calculate cbrt of a fraction and approximate it as a fraction.
+	[[nodiscard]] constexpr fraction cbrt() const noexcept {
+		return ( denominator == 0 )
+				   ? *this
+				   : to_fraction_using_stern_brocot_with_mediants< INT, error_exp >(
+						 std::cbrt( to_double() ) );
+	};
+	// Split fraction into two parts by extracting any squares(2), cubes(3) etc.
+	// See examples below.
+	[[nodiscard]] constexpr std::pair< fraction, fraction >
+	simplify_rt( const double rt ) const noexcept {
+		std::pair result{ f_1, *this };
+		auto [np_factor, np_remain] = simplify_root( numerator, rt );
+		auto [dp_factor, dp_remain] = simplify_root( denominator, rt );
+		if ( ( np_factor > 1 ) || ( dp_factor > 1 ) ) {
+			result = std::make_pair( fraction{ np_factor, dp_factor },
+									 np_remain / dp_remain );
+		};
+		return result;
+	};
+	// Split sqrt into two parts by extracting any squares.
+	// e.g. (56/45)     i.e. (2*2*2*7/3*3*5)          =>{(2/3),(14/5)}
+	//		(392/10125) i.e. (2*2*2*7*7/3*3*3*3*5*5*5)=>{(14/45),(2/5)}
+	[[nodiscard]] constexpr std::pair< fraction, fraction >
+	simplify_sqrt() const noexcept {
+		return simplify_rt( 2.0 );
+	};
+	// split cbrt into two parts by extracting any cubes.
+	// e.g. (56/135)      i.e. (2*2*2*7/3*3*3*5)            =>{(2/3),(7/5)}
+	//		(19208/10125) i.e. (2*2*2*7*7*7*7/3*3*3*3*5*5*5)=>{(14/15),(49/3)}
+	[[nodiscard]] constexpr std::pair< fraction, fraction >
+	simplify_cbrt() const noexcept {
+		return simplify_rt( 3.0 );
+	};
+
+	// operators+
+	constexpr fraction operator+( const fraction &rhs ) const {
+		return { numerator * rhs.den() + denominator * rhs.num(),
+				 denominator * rhs.den() };
+	};
+	constexpr fraction operator+( const INT &rhs ) const {
+		return { numerator + denominator * rhs, denominator };
+	};
+	constexpr fraction operator+( const double &rhs ) const {
+		return denominator == 0 ? *this : fraction{ to_double() + rhs };
+	};
+	constexpr fraction &operator+=( const fraction &rhs ) {
+		*this = *this + rhs;
+		return *this;
+	};
+	constexpr fraction &operator+=( const INT &rhs ) {
+		*this = *this + rhs;
+		return *this;
+	};
+	constexpr fraction &operator+=( const double &rhs ) {
+		*this = *this + rhs;
+		return *this;
+	};
+	constexpr friend fraction operator+( const INT &lhs, const fraction &rhs ) {
+		return rhs + lhs;
+	};
+	constexpr friend fraction operator+( const double &lhs,
+										 const fraction &rhs ) {
+		return rhs + lhs;
+	};
+	constexpr fraction &operator++() { //++f
+		set( numerator + denominator, denominator );
+		return *this;
+	};
+	constexpr fraction operator++( int ) { // f++
+		fraction tmp = *this;
+		set( numerator + denominator, denominator );
+		return tmp;
+	};
+
+	// operators-
+	constexpr fraction operator-() const {
+		return { -numerator, denominator };
+	};
+	constexpr fraction operator-( const fraction &rhs ) const {
+		return *this + ( -rhs );
+	};
+	constexpr fraction operator-( const INT &rhs ) const {
+		return *this + ( -rhs );
+	};
+	constexpr fraction operator-( const double &rhs ) const {
+		return *this + ( -rhs );
+	};
+	constexpr fraction &operator-=( const fraction &rhs ) {
+		*this += -rhs;
+		return *this;
+	};
+	constexpr fraction &operator-=( const INT &rhs ) {
+		*this += -rhs;
+		return *this;
+	};
+	constexpr fraction &operator-=( const double &rhs ) {
+		*this += -rhs;
+		return *this;
+	};
+	constexpr friend fraction operator-( const INT &lhs, const fraction &rhs ) {
+		return -rhs + lhs;
+	};
+	constexpr friend fraction operator-( const double &lhs,
+										 const fraction &rhs ) {
+		return -rhs + lhs;
+	};
+	constexpr fraction &operator--() { // --f
+		set( numerator - denominator, denominator );
+		return *this;
+	};
+	constexpr fraction operator--( int ) { // f--
+		fraction tmp = *this;
+		set( numerator - denominator, denominator );
+		return tmp;
+	};
+
+	// operators*
+	constexpr fraction operator*( const fraction &rhs ) const {
+		return { numerator * rhs.num(), denominator * rhs.den() };
+	};
+	constexpr fraction operator*( const INT &rhs ) const {
+		return { numerator * rhs, denominator };
+	};
+	constexpr fraction operator*( const double &rhs ) const {
+		return denominator == 0 ? *this : fraction{ to_double() * rhs };
+	};
+	constexpr fraction &operator*=( const fraction &rhs ) {
+		*this = ( *this ) * rhs;
+		return *this;
+	};
+	constexpr fraction &operator*=( const INT &rhs ) {
+		*this = ( *this ) * rhs;
+		return *this;
+	};
+	constexpr fraction &operator*=( const double &rhs ) {
+		*this = ( *this ) * rhs;
+		return *this;
+	};
+	constexpr friend fraction operator*( const INT lhs, const fraction &rhs ) {
+		return rhs * lhs;
+	};
+	constexpr friend fraction operator*( const double lhs,
+										 const fraction &rhs ) {
+		return rhs * lhs;
+	};
+
+	// operators/
+	constexpr fraction operator/( const fraction &rhs ) const {
+		return { numerator * rhs.den(), denominator * rhs.num() };
+	};
+	constexpr fraction operator/( const INT &rhs ) const {
+		return { numerator, denominator * rhs };
+	};
+	constexpr fraction operator/( const double &rhs ) const {
+		return ( denominator == 0 ) ? *this : fraction{ to_double() / rhs };
+	};
+	constexpr fraction &operator/=( const fraction &rhs ) {
+		*this = *this / rhs;
+		return *this;
+	};
+	constexpr fraction &operator/=( const INT &rhs ) {
+		*this = *this / rhs;
+		return *this;
+	};
+	constexpr fraction &operator/=( const double &rhs ) {
+		*this = *this / rhs;
+		return *this;
+	};
+	constexpr friend fraction operator/( const INT lhs, const fraction &rhs ) {
+		return fraction{ lhs * rhs.den(), rhs.num() };
+	};
+	constexpr friend fraction operator/( const double lhs,
+										 const fraction &rhs ) {
+		return rhs.num() == 0 ? rhs.inv()
+							  : fraction{ lhs * rhs.inv().to_double() };
+	};
+
+	// operators%
+	constexpr fraction operator%( const fraction &rhs ) const {
+		return ( ( rhs.num() == 0 ) || ( rhs.den() == 0 ) ||
+				 ( denominator == 0 ) )
+				   ? f_inf
+				   : *this -
+						 (INT)std::trunc( ( *this / rhs ).to_double() ) * rhs;
+	};
+	constexpr fraction operator%( const INT &rhs ) const {
+		return ( ( denominator == 0 ) || ( rhs == 0 ) )
+				   ? f_inf
+				   : *this -
+						 (INT)std::trunc( ( *this / rhs ).to_double() ) * rhs;
+	};
+	constexpr fraction operator%( const double &rhs ) const {
+		return ( denominator == 0 ) ? *this
+									: fraction{ std::fmod( to_double(), rhs ) };
+	};
+	constexpr fraction &operator%=( const fraction &rhs ) {
+		*this = *this % rhs;
+		return *this;
+	};
+	constexpr fraction &operator%=( const INT &rhs ) {
+		*this = *this % rhs;
+		return *this;
+	};
+	constexpr fraction &operator%=( const double &rhs ) {
+		*this = *this % rhs;
+		return *this;
+	};
+	constexpr friend fraction operator%( const INT lhs, const fraction &rhs ) {
+		return fraction{ lhs, 1 } % rhs;
+	};
+	constexpr friend fraction operator%( const double lhs,
+										 const fraction &rhs ) {
+		return ( rhs.den() == 0 )
+				   ? rhs
+				   : fraction{ std::fmod( lhs, rhs.to_double() ) };
+	};
+
+	// =
+	constexpr fraction &operator=( const fraction &rhs ) = default;
+	constexpr fraction &operator=( fraction &&rhs ) = default;
+
+	// Comparison operators:
+	constexpr bool operator==( const fraction &rhs ) const {
+		return ( numerator == rhs.num() ) && ( denominator == rhs.den() );
+	};
+	constexpr const std::strong_ordering
+	operator<=>( const fraction &rhs ) const {
+		return ( numerator * rhs.den() ) <=> ( rhs.num() * denominator );
+	};
+
+	// String manipulation, in fraction_io.hpp:
+	// The most chars to_chars() writes: "(" sign digits "/" digits ")".
+	static constexpr std::size_t max_chars =
+		2 * ( std::numeric_limits< INT >::digits10 + 2 ) + 3;
+	[[nodiscard]] std::string to_string() const noexcept( false );
+	[[nodiscard]] const std::string operator+( const std::string &rhs ) const
+		noexcept( false );
+
+
+  private:
+	// Tag for the from_reduced() constructor.
+	struct reduced {};
+	constexpr fraction( const INT num, const INT den, reduced ) noexcept
+		: initial_num{ num }, numerator{ num }, initial_den{ den },
+		  denominator{ den } {};
+
+	// Set method. A negative result is stored with the numerator.
+	constexpr void set( const INT num = 1, const INT den = 1 ) noexcept {
+		// standard undefined behaviour if denominator is 0
+		initial_num = num;
+		initial_den = den;
+		const INT gcd = std::gcd( num, den );
+		numerator = num / (INT)std::copysign( gcd, den );
+		denominator = ( ( den < 0 ) ? -den : den ) / gcd;
+	};
+	
+	// Split INT into two parts by extracting any squares(2), cubes(3) etc.
+	// See examples above. Squares and cubes come from the root_cache.
+	[[nodiscard]] constexpr std::pair< INT, fraction >
+	simplify_root( const INT i, const double root ) const noexcept {
+		if ( ( root == 2.0 ) || ( root == 3.0 ) ) {
+			const root_parts< INT > parts =
+				std::is_constant_evaluated()
+					? to_root_parts( i )
+					: detail::cached_root_parts( i );
+			return ( root == 2.0 )
+					   ? std::make_pair( parts.sq_factor,
+										 from_reduced( parts.sq_free, 1 ) )
+					   : std::make_pair( parts.cb_factor,
+										 from_reduced( parts.cb_free, 1 ) );
+		};
+		fraction remain{ i };
+		INT factor =
+			(INT)std::floor( std::pow( (double)detail::uabs( i ), 1.0 / root ) );
+		for ( ; factor != 0; --factor ) {
+			remain = fraction{ i, (INT)std::pow( factor, root ) };
+			if ( remain.denominator == 1 ) {
+				break;
+			};
+		};
+		if ( factor == 0 ) {
+			++factor;
+		};
+		return std::make_pair( factor, remain );
+	};
+
+	// Store the fraction.
+	INT initial_num;
+	INT numerator;
+	INT initial_den;
+	INT denominator;
+}; // class fraction
+
+template< std::integral INT, int error_exp >
+const fraction< INT, error_exp > fraction< INT, error_exp >::f_0{ 0, 1 };
+template< std::integral INT, int error_exp >
+const fraction< INT, error_exp > fraction< INT, error_exp >::f_1{ 1, 1 };
+template< std::integral INT, int error_exp >
+const fraction< INT, error_exp > fraction< INT, error_exp >::f_inf{ 1, 0 };
+
+namespace detail {
+
+// The Stern Brocot search for from into to, taking mediants until one is
+// within error of from or max_steps have been taken. true if within error.
+// The steps taken are added to *steps if given.
+template< std::integral INT, int error_exp >
+constexpr bool
+stern_brocot_search( const double from, fraction< INT, error_exp > &to,
+					 const std::size_t max_steps = std::numeric_limits< std::size_t >::max(),
+					 std::size_t *const steps = nullptr ) noexcept {
+	bool within = false;
+	std::size_t step = 0;
+	// save steps by not starting at infinity and 0
+	for ( fraction< INT, error_exp > high{ (INT)std::ceil( from ) },
+		  low{ (INT)std::floor( from ) };
+		  step != max_steps; ) {
+		++step;
+		to = mediant( low, high );
+		if ( to.to_double() - from > fraction< INT, error_exp >::error ) {
+			high = to;
+		} else if ( to.to_double() - from < -fraction< INT, error_exp >::error ) {
+			low = to;
+		} else {
+			within = true;
+			break;
+		};
+	};
+	if ( steps != nullptr ) {
+		*steps += step;
+	};
+	return within;
+};
+
+}; // namespace detail
+
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr fraction< INT, error_exp >
+to_fraction_using_stern_brocot_with_mediants( const double from ) noexcept {
+	fraction< INT, error_exp > med{};
+	detail::stern_brocot_search( from, med );
+	return med;
+};
+
+}; // namespace mth
+
+// Suffix operator for std::int64_t case.
+// Note: GCC fails to compile literal operator friends for template classes
+// [PR C++/61648] (gcc.gnu.org/bugzilla/show_bug.cgi?id=61648), but clang does.
+FRACTION_EXPORT constexpr mth::fraction< std::int64_t >
+operator""_f( const unsigned long long from ) {
+	return mth::fraction{ (std::int64_t)from };
+};
+FRACTION_EXPORT constexpr mth::fraction< std::int64_t >
+operator""_f( const long double from ) {
+	return mth::fraction{ (double)from };
+};
+
+#ifdef FRACTION_EXTERN_TEMPLATES
+FRACTION_EXPORT namespace mth {
+extern template class fraction< std::int32_t >;
+extern template class fraction< std::int64_t >;
+#if defined( __SIZEOF_INT128__ ) && !defined( __STRICT_ANSI__ )
+extern template class fraction< detail::int128_t >;
+#endif
+}; // namespace mth
+#endif
+
+#endif
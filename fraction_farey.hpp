@@ -0,0 +1,157 @@
+/*
+ * fraction_farey.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Enumerate every reduced fraction p/q in a range with q <= n, i.e. the
+// Farey sequence F_n extended to the whole number line.
+// Neighbouring terms a/b < c/d of F_n satisfy c*b - a*d == 1, so every term
+// is already in lowest terms and the next one follows from
+//   k = (n + b) / d, next = (k*c - a) / (k*d - b)
+// without a gcd. The start of a range is found by a Stern-Brocot descent
+// that takes runs of equal steps at once, so it is O(log n).
+// A range can be split into sub-ranges that are enumerated on separate
+// threads, see reduced_fractions().
+
+#ifndef FRACTION_FAREY_HPP
+#define FRACTION_FAREY_HPP
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+// Neighbours of x in F_n: left <= x < right with no other term of F_n
+// between them. x must be finite and n >= 1. The products of x with the
+// candidate terms are taken in detail::widened_t< INT >, so any x will do,
+// but the neighbours' numerators must fit in INT, which holds while
+// 2 * ( | x | + 1 ) * n does (for INT wider than 64 bits, which has no wider
+// type, so must the products, ( | x.num() | + x.den() ) * 2 * n).
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr std::pair< fraction< INT, error_exp >,
+								   fraction< INT, error_exp > >
+farey_neighbours( const fraction< INT, error_exp > &x, const INT n ) noexcept {
+	using fraction_type = fraction< INT, error_exp >;
+	using W = detail::widened_t< INT >;
+	const INT p = x.num();
+	const INT q = x.den();
+	const INT floor = p / q - ( ( p % q < 0 ) ? 1 : 0 );
+	INT a = floor, b = 1, c = floor + 1, d = 1;
+	while ( b + d <= n ) {
+		const INT max_steps = ( n - b ) / d;
+		const W left_gap = (W)p * b - (W)a * q;	 // >= 0 as a/b <= x
+		const W right_gap = (W)c * q - (W)p * d; // >  0 as x < c/d
+		if ( ( (W)a + c ) * q <= (W)p * ( (W)b + d ) ) {
+			// Mediant <= x, move left towards right.
+			const INT k = (INT)std::min< W >( left_gap / right_gap, max_steps );
+			a += k * c;
+			b += k * d;
+		} else {
+			// Mediant > x, move right towards left.
+			const INT k = ( left_gap == 0 )
+							  ? ( n - d ) / b
+							  : (INT)std::min< W >( ( right_gap - 1 ) / left_gap,
+													( n - d ) / b );
+			c += k * a;
+			d += k * b;
+		};
+	};
+	return std::make_pair( fraction_type::from_reduced( a, b ),
+						   fraction_type::from_reduced( c, d ) );
+};
+
+// Term of F_n after right, where left and right are neighbours in F_n.
+// Its numerator is within the bound of farey_neighbours().
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr fraction< INT, error_exp >
+farey_next( const fraction< INT, error_exp > &left,
+			const fraction< INT, error_exp > &right, const INT n ) noexcept {
+	const INT k = ( n + left.den() ) / right.den();
+	return fraction< INT, error_exp >::from_reduced(
+		k * right.num() - left.num(), k * right.den() - left.den() );
+};
+
+// Call fn( fraction ) for each reduced fraction in [lo, hi] (or [lo, hi) if
+// closed is false) with denominator <= n, in ascending order.
+template< std::integral INT, int error_exp, typename Fn >
+constexpr void for_each_reduced( const fraction< INT, error_exp > &lo,
+								 const fraction< INT, error_exp > &hi,
+								 const INT n, Fn &&fn, const bool closed = true ) {
+	auto [left, right] = farey_neighbours( lo, n );
+	if ( left != lo ) {
+		left = std::exchange( right, farey_next( left, right, n ) );
+	};
+	while ( closed ? ( left <= hi ) : ( left < hi ) ) {
+		fn( left );
+		left = std::exchange( right, farey_next( left, right, n ) );
+	};
+};
+
+// Split [lo, hi] into parts sub-ranges of equal width. Returns the parts + 1
+// boundaries, sub-range i is [result[i], result[i + 1]).
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::vector< fraction< INT, error_exp > >
+farey_split( const fraction< INT, error_exp > &lo,
+			 const fraction< INT, error_exp > &hi, const std::size_t parts ) {
+	std::vector< fraction< INT, error_exp > > result{ lo };
+	const auto width = hi - lo;
+	for ( std::size_t i = 1; i < parts; ++i ) {
+		result.push_back( lo + width * (INT)i / (INT)parts );
+	};
+	result.push_back( hi );
+	return result;
+};
+
+// All reduced fractions in [lo, hi] with denominator <= n, in ascending
+// order. The range is split across threads.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::vector< fraction< INT, error_exp > >
+reduced_fractions( const fraction< INT, error_exp > &lo,
+				   const fraction< INT, error_exp > &hi, const INT n,
+				   std::size_t threads = std::thread::hardware_concurrency() ) {
+	using fraction_type = fraction< INT, error_exp >;
+	threads = std::max< std::size_t >( threads, 1 );
+	const auto bounds = farey_split( lo, hi, threads );
+	std::vector< std::vector< fraction_type > > parts( threads );
+	{
+		std::vector< std::jthread > workers;
+		for ( std::size_t i = 0; i != threads; ++i ) {
+			workers.emplace_back( [&, i] {
+				for_each_reduced(
+					bounds[i], bounds[i + 1], n,
+					[&]( const fraction_type &f ) { parts[i].push_back( f ); },
+					i + 1 == threads );
+			} );
+		};
+	};
+	std::vector< fraction_type > result;
+	for ( auto &part : parts ) {
+		result.insert( result.end(), part.begin(), part.end() );
+	};
+	return result;
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * fraction_geometry.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Points with fraction coordinates and the exact orientation and in-circle
+// predicates, each returning the sign (-1, 0 or 1) of a determinant:
+//   orient2d( a, b, c ) > 0 if a, b, c turn counterclockwise
+//   orient3d( a, b, c, d ) > 0 if d is below the plane of a, b, c, where
+//     a, b, c appear counterclockwise from above
+//   incircle( a, b, c, d ) > 0 if d is inside the circle through a, b, c,
+//     where a, b, c turn counterclockwise
+// as in Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast
+// Robust Geometric Predicates".
+// The determinant is first evaluated in double. to_double() is within 3 ulp
+// of each coordinate, so the rounding error of the whole expression is
+// bounded by a small multiple of epsilon times its permanent (the same sum
+// of products with every term made positive). If the determinant is larger
+// than that bound its sign is right, which is nearly always. Otherwise the
+// sign is evaluated exactly: each point is scaled by the product of its
+// denominators, which does not change the sign, giving an integer
+// determinant that is evaluated in a wide_int with room for the result.
+// Coordinates must be finite.
+
+#ifndef FRACTION_GEOMETRY_HPP
+#define FRACTION_GEOMETRY_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "fraction.hpp"
+#include "fraction_wide.hpp"
+
+namespace mth {
+
+template< std::integral INT = std::int64_t, int error_exp = -6 > struct point2 {
+	fraction< INT, error_exp > x;
+	fraction< INT, error_exp > y;
+
+	[[nodiscard]] friend constexpr bool operator==( const point2 &,
+													const point2 & ) = default;
+};
+
+template< std::integral INT = std::int64_t, int error_exp = -6 > struct point3 {
+	fraction< INT, error_exp > x;
+	fraction< INT, error_exp > y;
+	fraction< INT, error_exp > z;
+
+	[[nodiscard]] friend constexpr bool operator==( const point3 &,
+													const point3 & ) = default;
+};
+
+namespace detail {
+
+inline constexpr double epsilon = std::numeric_limits< double >::epsilon();
+
+[[nodiscard]] constexpr int sign_of( const double d ) noexcept {
+	return ( d > 0.0 ) ? 1 : ( d < 0.0 ) ? -1 : 0;
+};
+
+template< typename T >
+[[nodiscard]] constexpr T det2( const T &a, const T &b, const T &c,
+								const T &d ) noexcept {
+	return a * d - b * c;
+};
+
+// | a0 a1 a2 |
+// | b0 b1 b2 |
+// | c0 c1 c2 |
+template< typename T >
+[[nodiscard]] constexpr T det3( const std::array< T, 3 > &a,
+								const std::array< T, 3 > &b,
+								const std::array< T, 3 > &c ) noexcept {
+	return a[0] * det2( b[1], b[2], c[1], c[2] ) -
+		   a[1] * det2( b[0], b[2], c[0], c[2] ) +
+		   a[2] * det2( b[0], b[1], c[0], c[1] );
+};
+
+// Rows a, b, c, d of a 4 x 4 determinant, by the 2 x 2 minors of the first
+// two and last two rows.
+template< typename T >
+[[nodiscard]] constexpr T
+det4( const std::array< T, 4 > &a, const std::array< T, 4 > &b,
+	  const std::array< T, 4 > &c, const std::array< T, 4 > &d ) noexcept {
+	const auto upper = [&]( const std::size_t i, const std::size_t j ) {
+		return det2( a[i], a[j], b[i], b[j] );
+	};
+	const auto lower = [&]( const std::size_t i, const std::size_t j ) {
+		return det2( c[i], c[j], d[i], d[j] );
+	};
+	return upper( 0, 1 ) * lower( 2, 3 ) - upper( 0, 2 ) * lower( 1, 3 ) +
+		   upper( 0, 3 ) * lower( 1, 2 ) + upper( 1, 2 ) * lower( 0, 3 ) -
+		   upper( 1, 3 ) * lower( 0, 2 ) + upper( 2, 3 ) * lower( 0, 1 );
+};
+
+}; // namespace detail
+
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr int orient2d( const point2< INT, error_exp > &a,
+									  const point2< INT, error_exp > &b,
+									  const point2< INT, error_exp > &c ) noexcept {
+	const double ax = a.x.to_double(), ay = a.y.to_double();
+	const double bx = b.x.to_double(), by = b.y.to_double();
+	const double cx = c.x.to_double(), cy = c.y.to_double();
+	const double det = ( ax - cx ) * ( by - cy ) - ( ay - cy ) * ( bx - cx );
+	const double permanent =
+		( std::abs( ax ) + std::abs( cx ) ) * ( std::abs( by ) + std::abs( cy ) ) +
+		( std::abs( ay ) + std::abs( cy ) ) * ( std::abs( bx ) + std::abs( cx ) );
+	if ( std::abs( det ) > 16.0 * detail::epsilon * permanent ) {
+		return detail::sign_of( det );
+	};
+	// Rows ( x * w, y * w, w ) with w the product of the denominators.
+	using wide = wide_int_for< 6 * sizeof( INT ) * 8 >;
+	const auto row = []( const point2< INT, error_exp > &p ) {
+		return std::array< wide, 3 >{ wide{ p.x.num() } * wide{ p.y.den() },
+									  wide{ p.y.num() } * wide{ p.x.den() },
+									  wide{ p.x.den() } * wide{ p.y.den() } };
+	};
+	return detail::det3( row( a ), row( b ), row( c ) ).sign();
+};
+
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr int orient3d( const point3< INT, error_exp > &a,
+									  const point3< INT, error_exp > &b,
+									  const point3< INT, error_exp > &c,
+									  const point3< INT, error_exp > &d ) noexcept {
+	const double dx = d.x.to_double(), dy = d.y.to_double(),
+				 dz = d.z.to_double();
+	const std::array< double, 3 > ad{ a.x.to_double() - dx, a.y.to_double() - dy,
+									  a.z.to_double() - dz };
+	const std::array< double, 3 > bd{ b.x.to_double() - dx, b.y.to_double() - dy,
+									  b.z.to_double() - dz };
+	const std::array< double, 3 > cd{ c.x.to_double() - dx, c.y.to_double() - dy,
+									  c.z.to_double() - dz };
+	const auto bound = [&]( const point3< INT, error_exp > &p ) {
+		return std::array< double, 3 >{
+			std::abs( p.x.to_double() ) + std::abs( dx ),
+			std::abs( p.y.to_double() ) + std::abs( dy ),
+			std::abs( p.z.to_double() ) + std::abs( dz ) };
+	};
+	const auto ab = bound( a ), bb = bound( b ), cb = bound( c );
+	const double det = detail::det3( ad, bd, cd );
+	const double permanent =
+		ab[2] * ( bb[0] * cb[1] + bb[1] * cb[0] ) +
+		bb[2] * ( cb[0] * ab[1] + cb[1] * ab[0] ) +
+		cb[2] * ( ab[0] * bb[1] + ab[1] * bb[0] );
+	if ( std::abs( det ) > 32.0 * detail::epsilon * permanent ) {
+		return detail::sign_of( det );
+	};
+	// Rows ( x * w, y * w, z * w, w ) with w the product of the denominators.
+	using wide = wide_int_for< 12 * sizeof( INT ) * 8 >;
+	const auto row = []( const point3< INT, error_exp > &p ) {
+		const wide x{ p.x.den() }, y{ p.y.den() }, z{ p.z.den() };
+		return std::array< wide, 4 >{
+			wide{ p.x.num() } * y * z, wide{ p.y.num() } * x * z,
+			wide{ p.z.num() } * x * y, x * y * z };
+	};
+	return detail::det4( row( a ), row( b ), row( c ), row( d ) ).sign();
+};
+
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr int incircle( const point2< INT, error_exp > &a,
+									  const point2< INT, error_exp > &b,
+									  const point2< INT, error_exp > &c,
+									  const point2< INT, error_exp > &d ) noexcept {
+	const double dx = d.x.to_double(), dy = d.y.to_double();
+	const auto lifted = [&]( const point2< INT, error_exp > &p ) {
+		const double x = p.x.to_double() - dx, y = p.y.to_double() - dy;
+		return std::array< double, 3 >{ x, y, x * x + y * y };
+	};
+	const auto bound = [&]( const point2< INT, error_exp > &p ) {
+		const double x = std::abs( p.x.to_double() ) + std::abs( dx ),
+					 y = std::abs( p.y.to_double() ) + std::abs( dy );
+		return std::array< double, 3 >{ x, y, x * x + y * y };
+	};
+	const auto ab = bound( a ), bb = bound( b ), cb = bound( c );
+	const double det = detail::det3( lifted( a ), lifted( b ), lifted( c ) );
+	const double permanent = ab[2] * ( bb[0] * cb[1] + bb[1] * cb[0] ) +
+							 bb[2] * ( cb[0] * ab[1] + cb[1] * ab[0] ) +
+							 cb[2] * ( ab[0] * bb[1] + ab[1] * bb[0] );
+	if ( std::abs( det ) > 64.0 * detail::epsilon * permanent ) {
+		return detail::sign_of( det );
+	};
+	// Rows ( x, y, x^2 + y^2, 1 ) * w^2 with w the product of the
+	// denominators.
+	using wide = wide_int_for< 16 * sizeof( INT ) * 8 >;
+	const auto row = []( const point2< INT, error_exp > &p ) {
+		const wide x_den{ p.x.den() }, y_den{ p.y.den() };
+		const wide hx = wide{ p.x.num() } * y_den, hy = wide{ p.y.num() } * x_den,
+				   w = x_den * y_den;
+		return std::array< wide, 4 >{ hx * w, hy * w, hx * hx + hy * hy, w * w };
+	};
+	return detail::det4( row( a ), row( b ), row( c ), row( d ) ).sign();
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,288 @@
+/*
+ * fraction_histogram.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// A histogram with exact fraction bin edges. Bin i holds the values x with
+// edges[i] <= x < edges[i + 1], values outside the edges (including the
+// infinities) are counted as under or over.
+// When the edges are evenly spaced the bin is found directly: with the first
+// edge A/k and the width S/k over a common denominator k, x = p/q falls in
+//   floor( ( p*k - A*q ) / ( q*S ) )
+// using one widened integer division. Otherwise a branch free binary search
+// over the edges as doubles finds the bin to within one, and at most a
+// couple of exact comparisons settle it.
+// The products are checked, and a value whose products overflow the widened
+// integer takes the search instead. The search's comparisons are exact too,
+// by checked cross products. Edges are given to from_edges().
+// fill() splits a range, of fractions or through a fraction_view, across
+// threads, each with its own counts, and merges them at the end.
+
+#ifndef FRACTION_HISTOGRAM_HPP
+#define FRACTION_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_view.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// a < b exactly, for finite a and b. By the cross products in widened_t
+// when they fit, as they always do for INT narrower than widened_t,
+// otherwise term by term of their continued fractions, which cannot
+// overflow.
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr bool exact_less( const fraction< INT, error_exp > &a,
+										 const fraction< INT, error_exp > &b ) noexcept {
+	using wide = widened_t< INT >;
+	wide lhs{};
+	wide rhs{};
+	if ( !__builtin_mul_overflow( (wide)a.num(), (wide)b.den(), &lhs ) &&
+		 !__builtin_mul_overflow( (wide)b.num(), (wide)a.den(), &rhs ) ) {
+		return lhs < rhs;
+	};
+	INT a_num = a.num();
+	INT a_den = a.den();
+	INT b_num = b.num();
+	INT b_den = b.den();
+	// Each step compares the whole parts, then the reciprocals of what is
+	// left, which reverses the order.
+	for ( bool reversed = false;; reversed = !reversed ) {
+		INT a_rem = a_num % a_den;
+		INT b_rem = b_num % b_den;
+		const INT a_whole = a_num / a_den - ( ( a_rem < 0 ) ? 1 : 0 );
+		const INT b_whole = b_num / b_den - ( ( b_rem < 0 ) ? 1 : 0 );
+		a_rem += ( a_rem < 0 ) ? a_den : 0;
+		b_rem += ( b_rem < 0 ) ? b_den : 0;
+		if ( a_whole != b_whole ) {
+			return ( a_whole < b_whole ) != reversed;
+		};
+		if ( ( a_rem == 0 ) || ( b_rem == 0 ) ) {
+			return ( a_rem != b_rem ) && ( ( a_rem == 0 ) != reversed );
+		};
+		a_num = std::exchange( a_den, a_rem );
+		b_num = std::exchange( b_den, b_rem );
+	};
+};
+
+}; // namespace detail
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class histogram {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+
+	// Nothing unless there are at least 2 edges, all finite and strictly
+	// ascending.
+	[[nodiscard]] static std::optional< histogram >
+	from_edges( std::vector< fraction_type > from ) {
+		if ( ( from.size() < 2 ) ||
+			 std::ranges::any_of( from, []( const auto &f ) { return f.den() == 0; } ) ||
+			 ( std::ranges::adjacent_find( from, []( const auto &a, const auto &b ) {
+				   return !detail::exact_less( a, b );
+			   } ) != from.end() ) ) {
+			return std::nullopt;
+		};
+		return histogram{ std::move( from ) };
+	};
+
+	// Bin of x, -1 if below the first edge or bins() if at or above the last.
+	[[nodiscard]] std::ptrdiff_t bin( const fraction_type &x ) const noexcept {
+		const auto last = (std::ptrdiff_t)counts.size();
+		if ( x.den() == 0 ) {
+			return x.is_neg() ? -1 : last;
+		};
+		wide num{};
+		wide den{};
+		wide offset{};
+		// Falls back to the search if a product overflows.
+		if ( uniform && !__builtin_mul_overflow( (wide)x.num(), (wide)scale, &num ) &&
+			 !__builtin_mul_overflow( first, (wide)x.den(), &offset ) &&
+			 !__builtin_sub_overflow( num, offset, &num ) &&
+			 !__builtin_mul_overflow( (wide)x.den(), step, &den ) ) {
+			const wide index = num / den - ( ( num % den < 0 ) ? 1 : 0 );
+			return ( index < 0 ) ? -1 : ( index >= last ) ? last
+														  : (std::ptrdiff_t)index;
+		};
+		const double key = x.to_double();
+		const double *base = keys.data();
+		for ( std::size_t n = keys.size(); n > 1; ) {
+			const std::size_t half = n / 2;
+			base = ( base[half] <= key ) ? base + half : base;
+			n -= half;
+		};
+		// The key is within one bin, settled exactly.
+		auto index = base - keys.data();
+		while ( ( index > 0 ) && detail::exact_less( x, edges[(std::size_t)index] ) ) {
+			--index;
+		};
+		while ( ( index < last ) &&
+				!detail::exact_less( x, edges[(std::size_t)index + 1] ) ) {
+			++index;
+		};
+		return detail::exact_less( x, edges[0] ) ? -1 : index;
+	};
+
+	void add( const fraction_type &x ) noexcept { count( x, counts, outside ); };
+	// Add a range, split across threads.
+	void fill( const std::span< const fraction_type > from,
+			   const std::size_t threads = std::thread::hardware_concurrency() ) {
+		fill_from( from, threads );
+	};
+	template< typename VIEW_INT >
+		requires std::same_as< std::remove_const_t< VIEW_INT >, INT >
+	void fill( fraction_view< VIEW_INT, error_exp > from,
+			   std::size_t threads = std::thread::hardware_concurrency() );
+
+	[[nodiscard]] std::size_t bins() const noexcept { return counts.size(); };
+	[[nodiscard]] bool is_uniform() const noexcept { return uniform; };
+	[[nodiscard]] std::span< const fraction_type > bin_edges() const noexcept {
+		return edges;
+	};
+	[[nodiscard]] std::span< const std::uint64_t > bin_counts() const noexcept {
+		return counts;
+	};
+	[[nodiscard]] std::uint64_t under() const noexcept { return outside[0]; };
+	[[nodiscard]] std::uint64_t over() const noexcept { return outside[1]; };
+
+  private:
+	using wide = detail::widened_t< INT >;
+
+	// The edges are evenly spaced if each difference, taken in wide and
+	// reduced, is the same and fits in INT, and the common denominator k
+	// fits in INT too.
+	explicit histogram( std::vector< fraction_type > from )
+		: edges{ std::move( from ) }, keys( edges.size() ),
+		  counts( edges.size() - 1, 0 ) {
+		std::ranges::transform( edges, keys.begin(), []( const auto &f ) {
+			return f.to_double();
+		} );
+		const auto difference = [&]( const std::size_t i, INT &num, INT &den ) {
+			wide lhs{};
+			wide rhs{};
+			wide d{};
+			return !__builtin_mul_overflow( (wide)edges[i].num(), (wide)edges[i - 1].den(),
+											&lhs ) &&
+				   !__builtin_mul_overflow( (wide)edges[i - 1].num(), (wide)edges[i].den(),
+											&rhs ) &&
+				   !__builtin_sub_overflow( lhs, rhs, &lhs ) &&
+				   !__builtin_mul_overflow( (wide)edges[i].den(), (wide)edges[i - 1].den(),
+											&d ) &&
+				   detail::narrow_reduced( lhs, d, num, den );
+		};
+		INT width_num{};
+		INT width_den{};
+		uniform = difference( 1, width_num, width_den );
+		for ( std::size_t i = 2; uniform && ( i < edges.size() ); ++i ) {
+			INT num{};
+			INT den{};
+			uniform = difference( i, num, den ) && ( num == width_num ) &&
+					  ( den == width_den );
+		};
+		const INT gcd = std::gcd( edges[0].den(), width_den );
+		INT k{};
+		if ( uniform &&
+			 !__builtin_mul_overflow( edges[0].den() / gcd, width_den, &k ) ) {
+			first = (wide)edges[0].num() * ( k / edges[0].den() );
+			step = (wide)width_num * ( k / width_den );
+			scale = k;
+		} else {
+			uniform = false;
+		};
+	};
+
+	// fill() of from, a span of fractions or a fraction_view.
+	template< typename R > void fill_from( const R &from, std::size_t threads );
+
+	void count( const fraction_type &x, std::vector< std::uint64_t > &to,
+				std::array< std::uint64_t, 2 > &to_outside ) const noexcept {
+		const auto index = bin( x );
+		if ( index < 0 ) {
+			++to_outside[0];
+		} else if ( index >= (std::ptrdiff_t)to.size() ) {
+			++to_outside[1];
+		} else {
+			++to[(std::size_t)index];
+		};
+	};
+
+	std::vector< fraction_type > edges;
+	std::vector< double > keys;
+	std::vector< std::uint64_t > counts;
+	std::array< std::uint64_t, 2 > outside{ 0, 0 };
+	bool uniform = false;
+	wide first = 0;
+	wide step = 1;
+	INT scale = 1;
+}; // class histogram
+
+// The member templates, out of the class so that they may end in "};".
+template< std::integral INT, int error_exp >
+template< typename VIEW_INT >
+	requires std::same_as< std::remove_const_t< VIEW_INT >, INT >
+void histogram< INT, error_exp >::fill( const fraction_view< VIEW_INT, error_exp > from,
+										const std::size_t threads ) {
+	fill_from( from, threads );
+};
+
+template< std::integral INT, int error_exp >
+template< typename R >
+void histogram< INT, error_exp >::fill_from( const R &from, std::size_t threads ) {
+	const std::size_t size = from.size();
+	threads = std::clamp< std::size_t >( threads, 1, std::max< std::size_t >( size, 1 ) );
+	std::vector< std::vector< std::uint64_t > > parts(
+		threads, std::vector< std::uint64_t >( counts.size(), 0 ) );
+	std::vector< std::array< std::uint64_t, 2 > > parts_outside(
+		threads, { 0, 0 } );
+	{
+		std::vector< std::jthread > workers;
+		for ( std::size_t i = 0; i != threads; ++i ) {
+			workers.emplace_back( [&, i] {
+				for ( std::size_t j = size * i / threads;
+					  j != size * ( i + 1 ) / threads; ++j ) {
+					count( fraction_type( from[j] ), parts[i], parts_outside[i] );
+				};
+			} );
+		};
+	};
+	for ( std::size_t i = 0; i != threads; ++i ) {
+		std::ranges::transform( counts, parts[i], counts.begin(),
+								std::plus<>{} );
+		outside[0] += parts_outside[i][0];
+		outside[1] += parts_outside[i][1];
+	};
+};
+
+}; // namespace mth
+
+#endif
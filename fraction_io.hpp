@@ -0,0 +1,99 @@
+/*
+ * fraction_io.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Text output for fractions: to_chars() into a buffer, which never
+// allocates, and to_string(), + with strings and << built on it. The forms
+// are "7", "(-7)" and "(7/3)".
+
+#ifndef FRACTION_IO_HPP
+#define FRACTION_IO_HPP
+
+#include <charconv>
+#include <ostream>
+#include <string>
+
+#include "fraction_core.hpp"
+
+FRACTION_EXPORT namespace mth {
+
+// Write the to_string() form to [first, last) without allocating. As
+// std::to_chars, { last, std::errc::value_too_large } if it does not fit.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::to_chars_result
+to_chars( char *first, char *const last, const fraction< INT, error_exp > &f ) noexcept {
+	const std::to_chars_result too_large{ last, std::errc::value_too_large };
+	const bool brackets = !f.is_int() || f.is_neg();
+	if ( brackets ) {
+		if ( first == last ) {
+			return too_large;
+		};
+		*first++ = '(';
+	};
+	auto result = std::to_chars( first, last, f.num() );
+	if ( ( result.ec == std::errc{} ) && !f.is_int() ) {
+		if ( result.ptr == last ) {
+			return too_large;
+		};
+		*result.ptr++ = '/';
+		result = std::to_chars( result.ptr, last, f.den() );
+	};
+	if ( ( result.ec == std::errc{} ) && brackets ) {
+		if ( result.ptr == last ) {
+			return too_large;
+		};
+		*result.ptr++ = ')';
+	};
+	return result;
+};
+
+template< std::integral INT, int error_exp >
+std::string fraction< INT, error_exp >::to_string() const noexcept( false ) {
+	std::array< char, max_chars > buffer;
+	return { buffer.data(),
+			 to_chars( buffer.data(), buffer.data() + buffer.size(), *this ).ptr };
+};
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::string
+to_string( const fraction< INT, error_exp > &f ) noexcept( false ) {
+	return f.to_string();
+};
+template< std::integral INT, int error_exp >
+const std::string
+fraction< INT, error_exp >::operator+( const std::string &rhs ) const
+	noexcept( false ) {
+	return to_string() + rhs;
+};
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::string operator+( const std::string &lhs,
+									 const fraction< INT, error_exp > &rhs ) noexcept( false ) {
+	return lhs + rhs.to_string();
+};
+template< std::integral INT, int error_exp >
+std::ostream &operator<<( std::ostream &os,
+						  const fraction< INT, error_exp > &f ) noexcept( false ) {
+	os << f.to_string();
+	return os;
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,631 @@
+/*
+ * fraction_lattice.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Hermite and Smith normal forms of integer matrices, for the lattice
+// spanned by their rows. A matrix of fractions is first brought to integers
+// by clear_denominators().
+//   hermite( a ) - H = U * A, upper triangular (echelon) with positive
+//                  pivots and 0 <= h[r][c] < pivot above each pivot.
+//   smith( a )   - S = U * A * V, diagonal with each entry dividing the next.
+// U and V are unimodular and only computed when asked for.
+// Without them, when the rows of A span the whole space (rank == columns),
+// the work is done modulo D, the determinant of some full set of independent
+// rows, found by fraction free (Bareiss) elimination. The lattice contains
+// D * Z^n, so any multiple of D can be added to any entry, keeping every
+// entry below D and products in widened integers (Domich, Kannan and
+// Trotter; Cohen, "A Course in Computational Algebraic Number Theory",
+// algorithm 2.4.8). Folding the rows below a pivot into it is split
+// across threads, each folding its own rows into one, when there is
+// enough work.
+// With U and V, or for a matrix of lower rank, the exact algorithms are
+// used with every operation checked. The Hermite form is then found by
+// Euclid's algorithm down each column, pivoting on the smallest entry, and
+// the rows of U that span the kernel are LLL reduced, the others reduced
+// against them, to keep U short. Either way nothing is returned when
+// something overflows INT, and an entry of the most negative INT is taken
+// as overflow, as it has no negation.
+
+#ifndef FRACTION_LATTICE_HPP
+#define FRACTION_LATTICE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+// A dense integer matrix, row major.
+template< std::integral INT = std::int64_t > struct int_matrix {
+	std::size_t rows = 0;
+	std::size_t cols = 0;
+	std::vector< INT > data;
+
+	int_matrix() = default;
+	int_matrix( const std::size_t rows, const std::size_t cols )
+		: rows{ rows }, cols{ cols }, data( rows * cols, 0 ) {};
+	[[nodiscard]] static int_matrix identity( const std::size_t size ) {
+		int_matrix result{ size, size };
+		for ( std::size_t i = 0; i != size; ++i ) {
+			result( i, i ) = 1;
+		};
+		return result;
+	};
+
+	[[nodiscard]] INT &operator()( const std::size_t r, const std::size_t c ) noexcept {
+		return data[r * cols + c];
+	};
+	[[nodiscard]] const INT &operator()( const std::size_t r,
+										 const std::size_t c ) const noexcept {
+		return data[r * cols + c];
+	};
+	[[nodiscard]] friend bool operator==( const int_matrix &,
+										  const int_matrix & ) = default;
+
+	// The product, nothing on overflow.
+	[[nodiscard]] std::optional< int_matrix > times( const int_matrix &rhs ) const {
+		int_matrix result{ rows, rhs.cols };
+		bool over = false;
+		for ( std::size_t r = 0; r != rows; ++r ) {
+			for ( std::size_t i = 0; i != cols; ++i ) {
+				for ( std::size_t c = 0; c != rhs.cols; ++c ) {
+					INT product;
+					over |= __builtin_mul_overflow( ( *this )( r, i ), rhs( i, c ),
+													&product );
+					over |= __builtin_add_overflow( result( r, c ), product,
+													&result( r, c ) );
+				};
+			};
+		};
+		return over ? std::nullopt : std::optional< int_matrix >{ result };
+	};
+};
+
+// form == left * a * right. left and right are empty unless asked for, and
+// right is always empty for hermite().
+template< std::integral INT = std::int64_t > struct normal_form {
+	int_matrix< INT > form;
+	int_matrix< INT > left;
+	int_matrix< INT > right;
+};
+
+// Integer matrix M and denominator d with from == M / d, from row major
+// with cols columns. Nothing if an entry is infinite or d overflows INT.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< std::pair< int_matrix< INT >, INT > >
+clear_denominators( const std::span< const fraction< INT, error_exp > > from,
+					const std::size_t cols ) {
+	const auto shared = detail::to_shared_denominator( from );
+	if ( !shared ) {
+		return std::nullopt;
+	};
+	int_matrix< INT > result{ ( cols == 0 ) ? 0 : from.size() / cols, cols };
+	result.data = shared->num;
+	return std::pair{ std::move( result ), shared->den[0] };
+};
+
+namespace detail {
+
+// gcd( a, b ) >= 0 with u * a + v * b == gcd. Neither may be the most
+// negative T, as a / b and -gcd could overflow.
+template< typename T > struct xgcd_result {
+	T gcd;
+	T u;
+	T v;
+};
+template< typename T > [[nodiscard]] constexpr xgcd_result< T > xgcd( T a, T b ) noexcept {
+	T u0 = 1, v0 = 0, u1 = 0, v1 = 1;
+	while ( b != 0 ) {
+		const T q = a / b;
+		a = std::exchange( b, a - q * b );
+		u0 = std::exchange( u1, u0 - q * u1 );
+		v0 = std::exchange( v1, v0 - q * v1 );
+	};
+	return ( a < 0 ) ? xgcd_result< T >{ -a, -u0, -v0 } : xgcd_result< T >{ a, u0, v0 };
+};
+
+// Whether x is the most negative INT, which has no negation.
+template< std::integral INT > [[nodiscard]] constexpr bool is_min( const INT x ) noexcept {
+	return std::is_signed_v< INT > && ( x == std::numeric_limits< INT >::min() );
+};
+
+template< typename T > [[nodiscard]] constexpr T floor_div( const T a, const T b ) noexcept {
+	const T q = a / b;
+	return ( ( a % b != 0 ) && ( ( a < 0 ) != ( b < 0 ) ) ) ? q - 1 : q;
+};
+
+// a mod m in [0, m).
+template< typename T > [[nodiscard]] constexpr T mod( const T a, const T m ) noexcept {
+	const T r = a % m;
+	return ( r < 0 ) ? r + m : r;
+};
+
+// |det| of the first full set of independent rows, by Bareiss elimination.
+// Nothing if the rank is below cols or a minor overflows.
+template< std::integral INT >
+[[nodiscard]] std::optional< INT > lattice_determinant( const int_matrix< INT > &a ) {
+	using wide = widened_t< INT >;
+	std::vector< wide > m( a.data.begin(), a.data.end() );
+	const auto at = [&]( const std::size_t r, const std::size_t c ) -> wide & {
+		return m[r * a.cols + c];
+	};
+	wide previous = 1;
+	for ( std::size_t c = 0; c != a.cols; ++c ) {
+		std::size_t p = c;
+		while ( ( p < a.rows ) && ( at( p, c ) == 0 ) ) {
+			++p;
+		};
+		if ( p >= a.rows ) {
+			return std::nullopt;
+		};
+		for ( std::size_t j = c; j != a.cols; ++j ) {
+			std::swap( at( c, j ), at( p, j ) );
+		};
+		for ( std::size_t i = c + 1; i != a.rows; ++i ) {
+			for ( std::size_t j = c + 1; j != a.cols; ++j ) {
+				wide x;
+				wide y;
+				if ( __builtin_mul_overflow( at( c, c ), at( i, j ), &x ) ||
+					 __builtin_mul_overflow( at( i, c ), at( c, j ), &y ) ||
+					 __builtin_sub_overflow( x, y, &x ) ) {
+					return std::nullopt;
+				};
+				at( i, j ) = x / previous;
+			};
+		};
+		previous = at( c, c );
+	};
+	const wide det = ( previous < 0 ) ? -previous : previous;
+	const auto result = (INT)det;
+	return ( result == det ) ? std::optional< INT >{ result } : std::nullopt;
+};
+
+// The Hermite form of a, rank a.cols, modulo its multiple d of the lattice
+// determinant, as a.cols rows.
+template< std::integral INT >
+[[nodiscard]] int_matrix< INT > hermite_modular( const int_matrix< INT > &a, const INT d,
+												 std::size_t threads ) {
+	using wide = widened_t< INT >;
+	const std::size_t n = a.cols;
+	int_matrix< INT > w = a;
+	for ( auto &x : w.data ) {
+		x = mod( x, d );
+	};
+	int_matrix< INT > h{ n, n };
+	INT r = d;
+	// Make row y zero in column c by unimodular operations on rows x and y,
+	// modulo r.
+	const auto combine = [&]( const std::size_t x, const std::size_t y,
+							  const std::size_t c, const INT modulus ) {
+		if ( w( y, c ) == 0 ) {
+			return;
+		};
+		const auto [g, u, v] = xgcd( w( x, c ), w( y, c ) );
+		const wide p = w( x, c ) / g;
+		const wide q = w( y, c ) / g;
+		for ( std::size_t j = c; j != n; ++j ) {
+			const wide wx = w( x, j );
+			const wide wy = w( y, j );
+			w( x, j ) = (INT)mod( u * wx + v * wy, (wide)modulus );
+			w( y, j ) = (INT)mod( p * wy - q * wx, (wide)modulus );
+		};
+	};
+	for ( std::size_t c = 0; c != n; ++c ) {
+		const std::size_t below = w.rows - c - 1;
+		const std::size_t parts =
+			( below * ( n - c ) < 1 << 16 )
+				? 1
+				: std::clamp< std::size_t >( threads, 1, std::max< std::size_t >( below, 1 ) );
+		const auto first = [&]( const std::size_t i ) {
+			return c + 1 + below * i / parts;
+		};
+		if ( parts > 1 ) {
+			std::vector< std::jthread > workers;
+			for ( std::size_t i = 0; i != parts; ++i ) {
+				workers.emplace_back( [&, i] {
+					for ( std::size_t y = first( i ) + 1; y < first( i + 1 ); ++y ) {
+						combine( first( i ), y, c, r );
+					};
+				} );
+			};
+		};
+		for ( std::size_t i = 0; i != parts; ++i ) {
+			if ( parts == 1 ) {
+				for ( std::size_t y = c + 1; y != w.rows; ++y ) {
+					combine( c, y, c, r );
+				};
+			} else if ( first( i ) < first( i + 1 ) ) {
+				combine( c, first( i ), c, r );
+			};
+		};
+		// The lattice has r * e_c, so the pivot is the gcd with r.
+		const auto [g, u, v] = xgcd( w( c, c ), r );
+		for ( std::size_t j = c + 1; j != n; ++j ) {
+			h( c, j ) = (INT)mod( (wide)u * w( c, j ), (wide)r );
+		};
+		h( c, c ) = g;
+		r /= g;
+	};
+	// Reduce above each pivot, the rest modulo d.
+	for ( std::size_t c = 1; c != n; ++c ) {
+		for ( std::size_t i = 0; i != c; ++i ) {
+			const wide q = floor_div( h( i, c ), h( c, c ) );
+			for ( std::size_t j = c; j != n; ++j ) {
+				h( i, j ) = (INT)mod( h( i, j ) - q * h( c, j ), (wide)d );
+			};
+		};
+	};
+	return h;
+};
+
+// a * x + b * y and c * x + e * y, checked, or when modulus is not 0 in
+// widened integers and reduced to ( -modulus / 2, modulus / 2 ].
+template< std::integral INT >
+void combine( INT &x, INT &y, const INT a, const INT b, const INT c, const INT e,
+			  const INT modulus, bool &over ) noexcept {
+	if ( modulus != 0 ) {
+		using wide = widened_t< INT >;
+		const auto centre = [&]( const wide v ) {
+			const INT r = (INT)mod( v, (wide)modulus );
+			return ( r > modulus / 2 ) ? (INT)( r - modulus ) : r;
+		};
+		const wide wx = x;
+		x = centre( a * wx + (wide)b * y );
+		y = centre( c * wx + (wide)e * y );
+		return;
+	};
+	INT ax, by, cx, ey;
+	over |= __builtin_mul_overflow( a, x, &ax );
+	over |= __builtin_mul_overflow( b, y, &by );
+	over |= __builtin_mul_overflow( c, x, &cx );
+	over |= __builtin_mul_overflow( e, y, &ey );
+	over |= __builtin_add_overflow( ax, by, &x );
+	over |= __builtin_add_overflow( cx, ey, &y );
+	over |= is_min( x ) || is_min( y );
+};
+
+// Rows (or columns) x and y of m become a * x + b * y and c * x + e * y.
+template< std::integral INT >
+void combine_rows( int_matrix< INT > &m, const std::size_t x, const std::size_t y,
+				   const INT a, const INT b, const INT c, const INT e, bool &over,
+				   const INT modulus = 0 ) {
+	for ( std::size_t j = 0; j != m.cols; ++j ) {
+		INT mx = m( x, j );
+		INT my = m( y, j );
+		combine( mx, my, a, b, c, e, modulus, over );
+		m( x, j ) = mx;
+		m( y, j ) = my;
+	};
+};
+template< std::integral INT >
+void combine_cols( int_matrix< INT > &m, const std::size_t x, const std::size_t y,
+				   const INT a, const INT b, const INT c, const INT e, bool &over,
+				   const INT modulus = 0 ) {
+	for ( std::size_t i = 0; i != m.rows; ++i ) {
+		INT mx = m( i, x );
+		INT my = m( i, y );
+		combine( mx, my, a, b, c, e, modulus, over );
+		m( i, x ) = mx;
+		m( i, y ) = my;
+	};
+};
+
+// Rows from onwards of u span the kernel, H being zero there, so adding them
+// to any row of u leaves H = U * A as it is. They are LLL reduced and each
+// row above them reduced against them by nearest plane, with Gram-Schmidt in
+// doubles. The row operations are exact, rounding only costing how short the
+// rows get, and u is kept as it was if one overflows.
+template< std::integral INT >
+void reduce_kernel( int_matrix< INT > &u, const std::size_t from ) {
+	if ( from >= u.rows ) {
+		return;
+	};
+	int_matrix< INT > reduced = u;
+	bool over = false;
+	const std::size_t n = u.cols;
+	std::vector< double > star( u.rows * n );
+	std::vector< double > norm( u.rows );
+	// The orthogonal parts of rows first to last, given those before.
+	const auto orthogonalise = [&]( const std::size_t first, const std::size_t last ) {
+		for ( std::size_t k = first; k != last; ++k ) {
+			double *const b = &star[k * n];
+			for ( std::size_t j = 0; j != n; ++j ) {
+				b[j] = (double)reduced( k, j );
+			};
+			for ( std::size_t i = from; i != k; ++i ) {
+				double mu = 0;
+				for ( std::size_t j = 0; j != n; ++j ) {
+					mu += (double)reduced( k, j ) * star[i * n + j];
+				};
+				mu /= norm[i];
+				for ( std::size_t j = 0; j != n; ++j ) {
+					b[j] -= mu * star[i * n + j];
+				};
+			};
+			norm[k] = 0;
+			for ( std::size_t j = 0; j != n; ++j ) {
+				norm[k] += b[j] * b[j];
+			};
+		};
+	};
+	// Row r less the nearest multiple of row k along k's orthogonal part.
+	const auto project = [&]( const std::size_t r, const std::size_t k ) {
+		double mu = 0;
+		for ( std::size_t j = 0; j != n; ++j ) {
+			mu += (double)reduced( r, j ) * star[k * n + j];
+		};
+		return mu / norm[k];
+	};
+	const auto subtract = [&]( const std::size_t r, const std::size_t k ) {
+		const double q = std::round( project( r, k ) );
+		if ( ( q != 0 ) && ( std::abs( q ) < (double)std::numeric_limits< INT >::max() ) ) {
+			combine_rows( reduced, r, k, (INT)1, (INT)-q, (INT)0, (INT)1, over );
+		};
+	};
+	orthogonalise( from, u.rows );
+	// The Lovasz condition with delta 3/4, and a bound on the swaps in case
+	// rounding keeps it from settling.
+	for ( std::size_t k = from + 1, swaps = 0;
+		  ( k < u.rows ) && !over && ( swaps != 64 * u.rows * u.rows ); ) {
+		for ( std::size_t i = k; i-- != from; ) {
+			subtract( k, i );
+		};
+		const double mu = project( k, k - 1 );
+		if ( norm[k] >= ( 0.75 - mu * mu ) * norm[k - 1] ) {
+			++k;
+		} else {
+			combine_rows( reduced, k - 1, k, (INT)0, (INT)1, (INT)1, (INT)0, over );
+			orthogonalise( k - 1, k + 1 );
+			k = std::max( k - 1, from + 1 );
+			++swaps;
+		};
+	};
+	for ( std::size_t r = 0; ( r != from ) && !over; ++r ) {
+		for ( std::size_t k = u.rows; k-- != from; ) {
+			subtract( r, k );
+		};
+	};
+	if ( !over ) {
+		u = std::move( reduced );
+	};
+};
+
+// The Hermite form and U, exactly, with U reduced if it is wanted.
+template< std::integral INT >
+[[nodiscard]] std::optional< normal_form< INT > >
+hermite_exact( const int_matrix< INT > &a, const bool transform ) {
+	normal_form< INT > result{ a, int_matrix< INT >::identity( a.rows ), {} };
+	auto &h = result.form;
+	bool over = std::ranges::any_of( a.data, is_min< INT > );
+	const auto rows = [&]( const std::size_t x, const std::size_t y, const INT p,
+						   const INT q, const INT s, const INT t ) {
+		combine_rows( h, x, y, p, q, s, t, over );
+		combine_rows( result.left, x, y, p, q, s, t, over );
+	};
+	std::size_t row = 0;
+	for ( std::size_t c = 0; ( c != a.cols ) && ( row != a.rows ) && !over; ++c ) {
+		while ( !over ) {
+			std::size_t p = a.rows;
+			for ( std::size_t y = row; y != a.rows; ++y ) {
+				if ( ( h( y, c ) != 0 ) &&
+					 ( ( p == a.rows ) || ( uabs( h( y, c ) ) < uabs( h( p, c ) ) ) ) ) {
+					p = y;
+				};
+			};
+			if ( p == a.rows ) {
+				break;
+			};
+			if ( p != row ) {
+				rows( row, p, 0, 1, 1, 0 );
+			};
+			bool clean = true;
+			for ( std::size_t y = row + 1; y != a.rows; ++y ) {
+				if ( h( y, c ) != 0 ) {
+					rows( y, row, 1, (INT)-( h( y, c ) / h( row, c ) ), 0, 1 );
+					clean &= ( h( y, c ) == 0 );
+				};
+			};
+			if ( clean ) {
+				break;
+			};
+		};
+		if ( h( row, c ) == 0 ) {
+			continue;
+		};
+		if ( h( row, c ) < 0 ) {
+			rows( row, row, -1, 0, -1, 0 );
+		};
+		for ( std::size_t i = 0; i != row; ++i ) {
+			rows( i, row, 1, (INT)-floor_div( h( i, c ), h( row, c ) ), 0, 1 );
+		};
+		++row;
+	};
+	if ( !over && transform ) {
+		reduce_kernel( result.left, row );
+	};
+	return over ? std::nullopt : std::optional{ std::move( result ) };
+};
+
+// Diagonalise m by pivoting on the smallest entry, applying each row and
+// column operation through rows() and cols(). With divisible, each pivot is
+// made to divide the rest.
+template< std::integral INT, typename ROWS, typename COLS >
+void diagonalise( int_matrix< INT > &m, const ROWS rows, const COLS cols,
+				  const bool divisible, const bool &over ) {
+	const auto abs = []( const INT x ) { return uabs( x ); };
+	for ( std::size_t t = 0; ( t != std::min( m.rows, m.cols ) ) && !over; ++t ) {
+		while ( !over ) {
+			std::size_t pi = t, pj = t;
+			for ( std::size_t i = t; i != m.rows; ++i ) {
+				for ( std::size_t j = t; j != m.cols; ++j ) {
+					if ( ( m( i, j ) != 0 ) &&
+						 ( ( m( pi, pj ) == 0 ) || ( abs( m( i, j ) ) < abs( m( pi, pj ) ) ) ) ) {
+						pi = i;
+						pj = j;
+					};
+				};
+			};
+			if ( m( pi, pj ) == 0 ) {
+				return;
+			};
+			if ( pi != t ) {
+				rows( t, pi, 0, 1, 1, 0 );
+			};
+			if ( pj != t ) {
+				cols( t, pj, 0, 1, 1, 0 );
+			};
+			bool clean = true;
+			for ( std::size_t i = t + 1; i != m.rows; ++i ) {
+				if ( m( i, t ) != 0 ) {
+					rows( i, t, 1, (INT)( -( m( i, t ) / m( t, t ) ) ), 0, 1 );
+					clean &= ( m( i, t ) == 0 );
+				};
+			};
+			for ( std::size_t j = t + 1; j != m.cols; ++j ) {
+				if ( m( t, j ) != 0 ) {
+					cols( j, t, 1, (INT)( -( m( t, j ) / m( t, t ) ) ), 0, 1 );
+					clean &= ( m( t, j ) == 0 );
+				};
+			};
+			if ( !clean ) {
+				continue;
+			};
+			std::size_t bad = m.rows;
+			for ( std::size_t i = t + 1; divisible && ( i != m.rows ) && ( bad == m.rows );
+				  ++i ) {
+				for ( std::size_t j = t + 1; j != m.cols; ++j ) {
+					if ( m( i, j ) % m( t, t ) != 0 ) {
+						bad = i;
+						break;
+					};
+				};
+			};
+			if ( bad == m.rows ) {
+				break;
+			};
+			rows( t, bad, 1, 1, 0, 1 );
+		};
+		if ( m( t, t ) < 0 ) {
+			rows( t, t, -1, 0, -1, 0 );
+		};
+	};
+};
+
+}; // namespace detail
+
+// The Hermite normal form of the rows of a, with U if transform.
+template< std::integral INT >
+[[nodiscard]] std::optional< normal_form< INT > >
+hermite( const int_matrix< INT > &a, const bool transform = false,
+		 const std::size_t threads = std::thread::hardware_concurrency() ) {
+	if ( !transform && ( a.cols != 0 ) ) {
+		if ( const auto d = detail::lattice_determinant( a ) ) {
+			normal_form< INT > result{ { a.rows, a.cols }, {}, {} };
+			const auto h = detail::hermite_modular( a, *d, threads );
+			std::copy( h.data.begin(), h.data.end(), result.form.data.begin() );
+			return result;
+		};
+	};
+	auto result = detail::hermite_exact( a, transform );
+	if ( result && !transform ) {
+		result->left = {};
+	};
+	return result;
+};
+
+// The Smith normal form of a, with U and V if transform.
+template< std::integral INT >
+[[nodiscard]] std::optional< normal_form< INT > >
+smith( const int_matrix< INT > &a, const bool transform = false,
+	   const std::size_t threads = std::thread::hardware_concurrency() ) {
+	bool over = false;
+	if ( !transform && ( a.cols != 0 ) ) {
+		if ( const auto d = detail::lattice_determinant( a ) ) {
+			// Diagonalise the Hermite form modulo d, then each invariant is
+			// the gcd of its entry with d, put in order by gcd and lcm.
+			auto h = detail::hermite_modular( a, *d, threads );
+			const auto rows = [&]( const std::size_t x, const std::size_t y, const INT p,
+								   const INT q, const INT s, const INT t ) {
+				detail::combine_rows( h, x, y, p, q, s, t, over, *d );
+			};
+			const auto cols = [&]( const std::size_t x, const std::size_t y, const INT p,
+								   const INT q, const INT s, const INT t ) {
+				detail::combine_cols( h, x, y, p, q, s, t, over, *d );
+			};
+			detail::diagonalise( h, rows, cols, false, over );
+			if ( !over ) {
+				std::vector< INT > invariants( a.cols );
+				for ( std::size_t i = 0; i != a.cols; ++i ) {
+					invariants[i] = std::gcd( h( i, i ), *d );
+				};
+				for ( std::size_t i = 0; i != a.cols; ++i ) {
+					for ( std::size_t j = i + 1; j != a.cols; ++j ) {
+						const INT g = std::gcd( invariants[i], invariants[j] );
+						invariants[j] = invariants[i] / g * invariants[j];
+						invariants[i] = g;
+					};
+				};
+				normal_form< INT > result{ { a.rows, a.cols }, {}, {} };
+				for ( std::size_t i = 0; i != a.cols; ++i ) {
+					result.form( i, i ) = invariants[i];
+				};
+				return result;
+			};
+			over = false;
+		};
+	};
+	over = std::ranges::any_of( a.data, detail::is_min< INT > );
+	normal_form< INT > result{ a, int_matrix< INT >::identity( a.rows ),
+							   int_matrix< INT >::identity( a.cols ) };
+	const auto rows = [&]( const std::size_t x, const std::size_t y, const INT p,
+						   const INT q, const INT s, const INT t ) {
+		detail::combine_rows( result.form, x, y, p, q, s, t, over );
+		detail::combine_rows( result.left, x, y, p, q, s, t, over );
+	};
+	const auto cols = [&]( const std::size_t x, const std::size_t y, const INT p,
+						   const INT q, const INT s, const INT t ) {
+		detail::combine_cols( result.form, x, y, p, q, s, t, over );
+		detail::combine_cols( result.right, x, y, p, q, s, t, over );
+	};
+	detail::diagonalise( result.form, rows, cols, true, over );
+	if ( over ) {
+		return std::nullopt;
+	};
+	if ( !transform ) {
+		result.left = {};
+		result.right = {};
+	};
+	return result;
+};
+
+}; // namespace mth
+
+#endif
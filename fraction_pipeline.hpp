@@ -0,0 +1,551 @@
+/*
+ * fraction_pipeline.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// A streaming pipeline for fraction data. Each stage is a coroutine
+// (pipeline_task) reading from one channel and writing to the next, and the
+// stages run together on a pipeline_pool:
+//   read_lines -> split_fields -> convert_fractions -> reduce -> write_lines
+// with transform() for any other step, e.g.
+//   pipeline_pool pool{ 4 };
+//   channel< std::string > lines, fields;
+//   channel< fraction<> > values, totals;
+//   pool.run( read_lines( in, lines ), split_fields( lines, fields ),
+//             convert_fractions( fields, values ),
+//             reduce( values, totals, fraction<>::f_0, std::plus<>{} ),
+//             write_lines( totals, out ) );
+// A channel is a bounded lock-free queue between one producer and one
+// consumer. co_await push() suspends the producer while it is full and
+// co_await pop() the consumer while it is empty, so a slow stage holds back
+// the ones before it. The other side resumes a suspended stage by handing
+// it back to the pool, and only once its push or pop can go ahead (or the
+// channel is closed), so co_await push() is only false, and co_await pop()
+// only nothing, when the channel really is closed. A stage closes its
+// channels when it ends, even by an exception, so the stages on either side
+// of it end too, and run() rethrows the first exception once every stage
+// has ended.
+
+#ifndef FRACTION_PIPELINE_HPP
+#define FRACTION_PIPELINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+// Threads resuming the stages of a pipeline.
+class pipeline_pool;
+
+// A pipeline stage. It starts when given to pipeline_pool::run().
+class pipeline_task {
+  public:
+	struct promise_type {
+		pipeline_pool *pool = nullptr;
+		std::exception_ptr error{};
+
+		[[nodiscard]] pipeline_task get_return_object() noexcept {
+			return pipeline_task{ handle::from_promise( *this ) };
+		};
+		[[nodiscard]] std::suspend_always initial_suspend() noexcept { return {}; };
+		struct final_awaiter {
+			[[nodiscard]] bool await_ready() noexcept { return false; };
+			void await_suspend( std::coroutine_handle< promise_type > h ) noexcept;
+			void await_resume() noexcept {};
+		};
+		[[nodiscard]] final_awaiter final_suspend() noexcept { return {}; };
+		void return_void() noexcept {};
+		void unhandled_exception() noexcept { error = std::current_exception(); };
+	};
+	using handle = std::coroutine_handle< promise_type >;
+
+	pipeline_task( pipeline_task &&from ) noexcept
+		: coroutine{ std::exchange( from.coroutine, nullptr ) } {};
+	pipeline_task &operator=( pipeline_task &&from ) noexcept {
+		std::swap( coroutine, from.coroutine );
+		return *this;
+	};
+	~pipeline_task() {
+		if ( coroutine ) {
+			coroutine.destroy();
+		};
+	};
+
+  private:
+	friend class pipeline_pool;
+	explicit pipeline_task( const handle h ) noexcept : coroutine{ h } {};
+
+	handle coroutine;
+}; // class pipeline_task
+
+class pipeline_pool {
+  public:
+	explicit pipeline_pool(
+		const std::size_t threads = std::thread::hardware_concurrency() ) {
+		for ( std::size_t i = 0; i != std::max< std::size_t >( threads, 1 ); ++i ) {
+			workers.emplace_back( [this]( const std::stop_token stop ) {
+				current_pool = this;
+				while ( true ) {
+					std::coroutine_handle<> next;
+					{
+						std::unique_lock lock{ mutex };
+						ready_changed.wait( lock, [&] {
+							return stop.stop_requested() || !ready.empty();
+						} );
+						if ( ready.empty() ) {
+							return;
+						};
+						next = ready.front();
+						ready.pop_front();
+					};
+					next.resume();
+				};
+			} );
+		};
+	};
+	pipeline_pool( const pipeline_pool & ) = delete;
+	pipeline_pool &operator=( const pipeline_pool & ) = delete;
+	~pipeline_pool() {
+		{
+			std::scoped_lock lock{ mutex };
+			for ( auto &worker : workers ) {
+				worker.request_stop();
+			};
+		};
+		ready_changed.notify_all();
+	};
+
+	// Run the stages until they have all ended, then rethrow the first
+	// exception any of them threw.
+	template< typename... TASKS > void run( TASKS &&...tasks );
+
+	void schedule( const std::coroutine_handle<> h ) {
+		{
+			std::scoped_lock lock{ mutex };
+			ready.push_back( h );
+		};
+		ready_changed.notify_one();
+	};
+	// The pool running the calling thread, if any.
+	[[nodiscard]] static pipeline_pool *current() noexcept { return current_pool; };
+
+  private:
+	friend struct pipeline_task::promise_type::final_awaiter;
+	void end_task() {
+		{
+			std::scoped_lock lock{ mutex };
+			--running;
+		};
+		ended.notify_all();
+	};
+
+	static inline thread_local pipeline_pool *current_pool = nullptr;
+	std::mutex mutex;
+	std::condition_variable ready_changed;
+	std::condition_variable ended;
+	std::deque< std::coroutine_handle<> > ready;
+	std::size_t running = 0;
+	// Last, so the workers stop before the rest goes.
+	std::vector< std::jthread > workers;
+}; // class pipeline_pool
+
+template< typename... TASKS > void pipeline_pool::run( TASKS &&...tasks ) {
+	running = sizeof...( tasks );
+	( ( tasks.coroutine.promise().pool = this ), ... );
+	( schedule( tasks.coroutine ), ... );
+	{
+		std::unique_lock lock{ mutex };
+		ended.wait( lock, [&] { return running == 0; } );
+	};
+	std::exception_ptr error{};
+	( ( error = error ? error : tasks.coroutine.promise().error ), ... );
+	if ( error ) {
+		std::rethrow_exception( error );
+	};
+};
+
+// Nothing may touch the frame once the pool knows the stage has ended.
+inline void pipeline_task::promise_type::final_awaiter::await_suspend(
+	const std::coroutine_handle< promise_type > h ) noexcept {
+	h.promise().pool->end_task();
+};
+
+// A bounded single producer, single consumer queue, capacity rounded up to
+// a power of 2.
+template< typename T > class channel {
+  public:
+	explicit channel( const std::size_t capacity = 64 )
+		: mask{ std::bit_ceil( std::max< std::size_t >( capacity, 1 ) ) - 1 },
+		  slots{ std::make_unique< T[] >( mask + 1 ) } {};
+	channel( const channel & ) = delete;
+	channel &operator=( const channel & ) = delete;
+
+	// co_await push( x ) is false, dropping x, if the channel is closed.
+	[[nodiscard]] auto push( T value ) noexcept {
+		struct awaiter {
+			channel &ch;
+			T value;
+			bool pushed = false;
+
+			[[nodiscard]] bool await_ready() noexcept {
+				pushed = !ch.is_closed() && ch.try_push( value );
+				return pushed || ch.is_closed();
+			};
+			void await_suspend( const std::coroutine_handle<> h ) noexcept {
+				ch.wait( ch.waiting_producer, h, ch.producer_ready() );
+			};
+			// Only resumed once there is room or the channel is closed, and
+			// only this producer takes the room away.
+			[[nodiscard]] bool await_resume() noexcept {
+				return pushed || ( !ch.is_closed() && ch.try_push( value ) );
+			};
+		};
+		return awaiter{ *this, std::move( value ) };
+	};
+	// co_await pop() is nothing once the channel is closed and empty.
+	[[nodiscard]] auto pop() noexcept {
+		struct awaiter {
+			channel &ch;
+			std::optional< T > value{};
+
+			[[nodiscard]] bool await_ready() noexcept {
+				value = ch.try_pop();
+				return value || ch.is_closed();
+			};
+			void await_suspend( const std::coroutine_handle<> h ) noexcept {
+				ch.wait( ch.waiting_consumer, h, ch.consumer_ready() );
+			};
+			// Only resumed once there is a value or the channel is closed,
+			// and only this consumer takes values away.
+			[[nodiscard]] std::optional< T > await_resume() noexcept {
+				return value ? std::move( value ) : ch.try_pop();
+			};
+		};
+		return awaiter{ *this };
+	};
+
+	// Without waiting, false if full.
+	[[nodiscard]] bool try_push( T &value ) noexcept {
+		const std::size_t t = tail.load( std::memory_order_relaxed );
+		if ( t - head.load( std::memory_order_acquire ) > mask ) {
+			return false;
+		};
+		slots[t & mask] = std::move( value );
+		tail.store( t + 1 );
+		wake( waiting_consumer, consumer_ready() );
+		return true;
+	};
+	// Without waiting, nothing if empty.
+	[[nodiscard]] std::optional< T > try_pop() noexcept {
+		const std::size_t h = head.load( std::memory_order_relaxed );
+		if ( h == tail.load( std::memory_order_acquire ) ) {
+			return std::nullopt;
+		};
+		std::optional< T > result{ std::move( slots[h & mask] ) };
+		head.store( h + 1 );
+		wake( waiting_producer, producer_ready() );
+		return result;
+	};
+
+	// No more pushes. What is already in the channel can still be popped.
+	void close() noexcept {
+		closed.store( true );
+		wake( waiting_producer, producer_ready() );
+		wake( waiting_consumer, consumer_ready() );
+	};
+	[[nodiscard]] bool is_closed() const noexcept { return closed.load(); };
+	[[nodiscard]] bool empty() const noexcept { return head.load() == tail.load(); };
+	[[nodiscard]] bool full() const noexcept { return tail.load() - head.load() > mask; };
+
+  private:
+	// What a suspended producer or consumer waits for. Once true it stays
+	// true until that side itself pushes or pops.
+	[[nodiscard]] auto producer_ready() const noexcept {
+		return [this] { return is_closed() || !full(); };
+	};
+	[[nodiscard]] auto consumer_ready() const noexcept {
+		return [this] { return is_closed() || !empty(); };
+	};
+
+	// Publish h as waiting, then look again in case ready() became true
+	// before the other side could see it, and if so wake it as that side
+	// would have. It is never resumed from here: once h is published another
+	// thread may resume it and it may wait again, at the same address, before
+	// this returns.
+	template< typename READY >
+	void wait( std::atomic< void * > &waiting, std::coroutine_handle<> h,
+			   READY ready ) noexcept;
+	// Resume the side waiting, if ready() now holds for it. The handle taken
+	// may be from a wait() after the change that called wake(), that side
+	// having already pushed or popped past it and suspended again, so ready()
+	// is checked once it is taken. If it does not hold the stage is put back
+	// to wait on, and ready() looked at again in case the change it waits
+	// for came while it was taken.
+	template< typename READY >
+	void wake( std::atomic< void * > &waiting, READY ready ) noexcept;
+
+	const std::size_t mask;
+	std::unique_ptr< T[] > slots;
+	alignas( 64 ) std::atomic< std::size_t > head{ 0 };
+	alignas( 64 ) std::atomic< std::size_t > tail{ 0 };
+	alignas( 64 ) std::atomic< bool > closed{ false };
+	std::atomic< void * > waiting_producer{ nullptr };
+	std::atomic< void * > waiting_consumer{ nullptr };
+	std::atomic< pipeline_pool * > pool{ nullptr };
+}; // class channel
+
+// wait() and wake(), whose ready() is one of the lambdas above.
+template< typename T >
+template< typename READY >
+void channel< T >::wait( std::atomic< void * > &waiting,
+						const std::coroutine_handle<> h, const READY ready ) noexcept {
+	pool.store( pipeline_pool::current() );
+	waiting.store( h.address() );
+	if ( ready() ) {
+		wake( waiting, ready );
+	};
+};
+
+template< typename T >
+template< typename READY >
+void channel< T >::wake( std::atomic< void * > &waiting, const READY ready ) noexcept {
+	while ( waiting.load() != nullptr ) {
+		void *const h = waiting.exchange( nullptr );
+		if ( h == nullptr ) {
+			return;
+		};
+		if ( ready() ) {
+			pool.load()->schedule( std::coroutine_handle<>::from_address( h ) );
+			return;
+		};
+		waiting.store( h );
+		if ( !ready() ) {
+			return;
+		};
+	};
+};
+
+namespace detail {
+
+// Closes channels when a stage ends, however it ends.
+template< typename... CHANNELS > struct channel_closer {
+	std::tuple< CHANNELS &... > channels;
+	explicit channel_closer( CHANNELS &...to ) noexcept : channels{ to... } {};
+	~channel_closer() {
+		std::apply( []( auto &...ch ) { ( ch.close(), ... ); }, channels );
+	};
+};
+
+// d * 10^e, false on overflow.
+template< std::integral INT >
+[[nodiscard]] constexpr bool scale10( INT &d, int e ) noexcept {
+	for ( ; e > 0; --e ) {
+		if ( __builtin_mul_overflow( d, INT{ 10 }, &d ) ) {
+			return false;
+		};
+	};
+	return true;
+};
+
+}; // namespace detail
+
+// A fraction from "n/d", or exactly from a decimal such as "-1.25e-3" when
+// it fits, otherwise by fraction( double ). Nothing if text is not a number,
+// is infinite or nan, or is too big for INT.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+parse_fraction( const std::string_view text ) noexcept {
+	const char *const first = text.data();
+	const char *const last = first + text.size();
+	if ( const auto slash = text.find( '/' ); slash != std::string_view::npos ) {
+		INT num{};
+		INT den{};
+		const auto [num_end, num_error] = std::from_chars( first, first + slash, num );
+		const auto [den_end, den_error] = std::from_chars( first + slash + 1, last, den );
+		if ( ( num_error != std::errc{} ) || ( den_error != std::errc{} ) ||
+			 ( num_end != first + slash ) || ( den_end != last ) || ( den == 0 ) ) {
+			return std::nullopt;
+		};
+		return fraction< INT, error_exp >{ num, den };
+	};
+	double d{};
+	const auto [end, error] = std::from_chars( first, last, d );
+	if ( ( error != std::errc{} ) || ( end != last ) || !std::isfinite( d ) ) {
+		return std::nullopt;
+	};
+	// Digits and exponent, exactly if they fit.
+	const bool negative = ( text.front() == '-' );
+	INT mantissa = 0;
+	int exponent = 0;
+	bool exact = true;
+	bool point = false;
+	const char *p = first + ( negative ? 1 : 0 );
+	for ( ; ( p != last ) && ( ( *p == '.' ) || ( ( *p >= '0' ) && ( *p <= '9' ) ) );
+		  ++p ) {
+		if ( *p == '.' ) {
+			point = true;
+			continue;
+		};
+		exact &= detail::scale10( mantissa, 1 ) &&
+				 !__builtin_add_overflow( mantissa, (INT)( *p - '0' ), &mantissa );
+		exponent -= point ? 1 : 0;
+	};
+	if ( ( p != last ) && ( ( *p == 'e' ) || ( *p == 'E' ) ) ) {
+		int shift{};
+		const auto [shift_end, shift_error] = std::from_chars(
+			p + 1 + ( ( ( p + 1 != last ) && ( p[1] == '+' ) ) ? 1 : 0 ), last, shift );
+		exact &= ( shift_error == std::errc{} ) &&
+				 !__builtin_add_overflow( exponent, shift, &exponent );
+	};
+	if ( exact && ( mantissa == 0 ) ) {
+		return fraction< INT, error_exp >{ INT{ 0 } };
+	};
+	// A power of ten past digits10 cannot fit, so is not looped over.
+	constexpr int digits = std::numeric_limits< INT >::digits10;
+	INT den = 1;
+	exact = exact && ( exponent >= -digits ) && ( exponent <= digits ) &&
+			( ( exponent < 0 ) ? detail::scale10( den, -exponent )
+							   : detail::scale10( mantissa, exponent ) );
+	if ( !exact ) {
+		// fraction( double ) needs the integer part to fit.
+		if ( std::abs( d ) >= (double)std::numeric_limits< INT >::max() ) {
+			return std::nullopt;
+		};
+		return fraction< INT, error_exp >{ d };
+	};
+	return fraction< INT, error_exp >{ negative ? -mantissa : mantissa, den };
+};
+
+// Stages. Each ends when its input is closed and empty, or its output is
+// closed, closing both.
+
+// Each line of in.
+inline pipeline_task read_lines( std::istream &in, channel< std::string > &out ) {
+	const detail::channel_closer closer{ out };
+	for ( std::string line; std::getline( in, line ); ) {
+		if ( !co_await out.push( std::move( line ) ) ) {
+			break;
+		};
+	};
+}
+
+// The fields of each line, split at white space and commas.
+inline pipeline_task split_fields( channel< std::string > &in,
+								   channel< std::string > &out ) {
+	const detail::channel_closer closer{ in, out };
+	while ( const auto line = co_await in.pop() ) {
+		const std::string_view text{ *line };
+		for ( std::size_t start = 0; start < text.size(); ) {
+			const std::size_t end = std::min( text.find_first_of( " \t\r,", start ),
+											  text.size() );
+			if ( ( end != start ) &&
+				 !co_await out.push( std::string{ text.substr( start, end - start ) } ) ) {
+				co_return;
+			};
+			start = end + 1;
+		};
+	};
+}
+
+// Each field parsed by parse_fraction(), skipping any that are not
+// numbers. rejected, if given, counts them.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+pipeline_task convert_fractions( channel< std::string > &in,
+								 channel< fraction< INT, error_exp > > &out,
+								 std::size_t *rejected = nullptr ) {
+	const detail::channel_closer closer{ in, out };
+	while ( const auto field = co_await in.pop() ) {
+		const auto f = parse_fraction< INT, error_exp >( *field );
+		if ( !f ) {
+			if ( rejected != nullptr ) {
+				++*rejected;
+			};
+		} else if ( !co_await out.push( *f ) ) {
+			break;
+		};
+	};
+}
+
+// f( x ) for each x.
+template< typename IN, typename OUT, typename F >
+pipeline_task transform( channel< IN > &in, channel< OUT > &out, F f ) {
+	const detail::channel_closer closer{ in, out };
+	while ( auto x = co_await in.pop() ) {
+		if ( !co_await out.push( f( std::move( *x ) ) ) ) {
+			break;
+		};
+	};
+}
+
+// op( ... op( op( init, x0 ), x1 ) ..., xn ) over all the values, or over
+// each batch values when batch is not 0.
+template< typename T, typename OP >
+pipeline_task reduce( channel< T > &in, channel< T > &out, const T init, OP op,
+					  const std::size_t batch = 0 ) {
+	const detail::channel_closer closer{ in, out };
+	T result = init;
+	std::size_t count = 0;
+	while ( auto x = co_await in.pop() ) {
+		result = op( std::move( result ), std::move( *x ) );
+		if ( ++count == batch ) {
+			if ( !co_await out.push( std::exchange( result, init ) ) ) {
+				co_return;
+			};
+			count = 0;
+		};
+	};
+	if ( ( batch == 0 ) || ( count != 0 ) ) {
+		(void)co_await out.push( std::move( result ) );
+	};
+}
+
+// Each value to out, one per line, as by <<.
+template< typename T > pipeline_task write_lines( channel< T > &in, std::ostream &out ) {
+	const detail::channel_closer closer{ in };
+	while ( const auto x = co_await in.pop() ) {
+		out << *x << '\n';
+	};
+}
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * fraction_pool.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// An intern table for fractions. Each distinct (reduced) fraction is stored
+// once and handed out as a dense 32 bit id, so large columns that repeat a
+// few values can hold 4 byte handles instead of whole fraction objects.
+//   ids are allocated in insertion order starting at 0.
+//   at() and to_double() are O(1) lookups by id.
+//   sort() builds a rank per id so compare() is a single integer compare.
+// All members may be called concurrently. Lookups by id take no lock: each
+// fraction is kept in chunks of 64, 128, 256, ... that never move, with the
+// number interned published atomically. sort() writes the ranks to whichever
+// of two sets was not used last and then publishes it, and rank() and
+// compare() read again if a sort() finished while they were reading.
+
+#ifndef FRACTION_POOL_HPP
+#define FRACTION_POOL_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class fraction_pool {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using id_type = std::uint32_t;
+
+	// Id returned by find() for fractions not in the pool.
+	static constexpr id_type npos = std::numeric_limits< id_type >::max();
+
+	fraction_pool() = default;
+	explicit fraction_pool( const std::size_t reserve ) {
+		for ( std::size_t k = 0;
+			  ( k != chunk_count ) && ( ( ( std::size_t{ 1 } << k ) - 1 ) * chunk_0 < reserve );
+			  ++k ) {
+			add_chunk( k );
+		};
+		index.reserve( reserve );
+	};
+	fraction_pool( const fraction_pool & ) = delete;
+	fraction_pool &operator=( const fraction_pool & ) = delete;
+
+	// Return the id of f, adding it to the pool if it is not there yet.
+	// Throws std::length_error once every 32 bit id is in use.
+	[[nodiscard]] id_type intern( const fraction_type &f ) noexcept( false ) {
+		const key k{ f.num(), f.den() };
+		{
+			std::shared_lock lock{ mutex };
+			if ( const auto it = index.find( k ); it != index.end() ) {
+				return it->second;
+			};
+		};
+		std::unique_lock lock{ mutex };
+		if ( const auto it = index.find( k ); it != index.end() ) {
+			return it->second;
+		};
+		const std::size_t id = count.load( std::memory_order_relaxed );
+		if ( id >= npos ) {
+			throw std::length_error( "fraction_pool: out of ids" );
+		};
+		const auto [chunk, offset] = locate( (id_type)id );
+		if ( offset == 0 ) {
+			add_chunk( chunk );
+		};
+		slot &to = chunks[chunk].load( std::memory_order_relaxed )[offset];
+		to.value = f;
+		to.as_double = f.to_double();
+		index.emplace( k, (id_type)id );
+		count.store( id + 1, std::memory_order_release );
+		return (id_type)id;
+	};
+	// Intern a whole column, writing one id per fraction.
+	void intern( const std::span< const fraction_type > from,
+				 const std::span< id_type > ids ) noexcept( false ) {
+		const std::size_t size = std::min( from.size(), ids.size() );
+		for ( std::size_t i = 0; i != size; ++i ) {
+			ids[i] = intern( from[i] );
+		};
+	};
+	// Id of f, or npos if f has not been interned.
+	[[nodiscard]] id_type find( const fraction_type &f ) const {
+		std::shared_lock lock{ mutex };
+		const auto it = index.find( key{ f.num(), f.den() } );
+		return ( it == index.end() ) ? npos : it->second;
+	};
+
+	// Lookups by id. The id must have come from this pool.
+	[[nodiscard]] fraction_type at( const id_type id ) const noexcept {
+		return get( id ).value;
+	};
+	[[nodiscard]] double to_double( const id_type id ) const noexcept {
+		return get( id ).as_double;
+	};
+	// Number of distinct fractions interned.
+	[[nodiscard]] std::size_t size() const noexcept {
+		return count.load( std::memory_order_acquire );
+	};
+
+	// Rank every id by value so compare() need not multiply. Fractions
+	// interned after the last sort() fall back to exact comparison.
+	void sort() {
+		std::unique_lock lock{ mutex };
+		std::vector< id_type > order( count.load( std::memory_order_relaxed ) );
+		std::iota( order.begin(), order.end(), id_type{ 0 } );
+		std::ranges::sort( order, [this]( id_type a, id_type b ) {
+			return get( a ).value < get( b ).value;
+		} );
+		const std::uint64_t next = generation.load( std::memory_order_relaxed ) + 1;
+		// The set written was last read as of generation next - 2, so a reader
+		// that sees any of these stores must see a later generation too.
+		std::atomic_thread_fence( std::memory_order_release );
+		for ( std::size_t i = 0; i != order.size(); ++i ) {
+			get( order[i] ).ranks[next & 1].store( (id_type)i, std::memory_order_relaxed );
+		};
+		ranked[next & 1].store( order.size(), std::memory_order_relaxed );
+		generation.store( next, std::memory_order_release );
+	};
+	// Rank of id in sorted order, or npos if sort() has not seen it.
+	[[nodiscard]] id_type rank( const id_type id ) const noexcept {
+		return ranks_of( id, id ).first;
+	};
+	// Compare the fractions behind two ids.
+	[[nodiscard]] std::strong_ordering compare( const id_type a,
+												const id_type b ) const noexcept {
+		const auto ranks = ranks_of( a, b );
+		if ( ranks.first != npos ) {
+			return ranks.first <=> ranks.second;
+		};
+		return get( a ).value <=> get( b ).value;
+	};
+
+  private:
+	struct key {
+		INT num;
+		INT den;
+		constexpr bool operator==( const key & ) const = default;
+	};
+	struct key_hash {
+		std::size_t operator()( const key &k ) const noexcept {
+			return detail::hash_fraction( k.num, k.den );
+		};
+	};
+	struct slot {
+		fraction_type value;
+		double as_double = 0;
+		// The ranks from the last two sort()s, by generation & 1.
+		std::array< std::atomic< id_type >, 2 > ranks{};
+	};
+
+	// Chunk k holds ids from chunk_0 * ( 2^k - 1 ), for chunk_0 << k ids.
+	static constexpr std::size_t chunk_0 = 64;
+	static constexpr std::size_t chunk_count = 33 - std::countr_zero( chunk_0 );
+	[[nodiscard]] static std::pair< std::size_t, std::size_t >
+	locate( const id_type id ) noexcept {
+		const std::size_t k = (std::size_t)std::bit_width( id / chunk_0 + std::size_t{ 1 } ) - 1;
+		return { k, id - ( ( std::size_t{ 1 } << k ) - 1 ) * chunk_0 };
+	};
+	[[nodiscard]] slot &get( const id_type id ) const noexcept {
+		const auto [chunk, offset] = locate( id );
+		return chunks[chunk].load( std::memory_order_acquire )[offset];
+	};
+	// Under the unique lock.
+	void add_chunk( const std::size_t k ) {
+		if ( !owned[k] ) {
+			owned[k] = std::make_unique< slot[] >( chunk_0 << k );
+			chunks[k].store( owned[k].get(), std::memory_order_release );
+		};
+	};
+	// The ranks of a and b from the last sort(), both npos unless it saw
+	// both, read again if another sort() was published meanwhile.
+	[[nodiscard]] std::pair< id_type, id_type > ranks_of( const id_type a,
+														  const id_type b ) const noexcept {
+		while ( true ) {
+			const std::uint64_t g = generation.load( std::memory_order_acquire );
+			const std::size_t set = g & 1;
+			const std::size_t seen = ranked[set].load( std::memory_order_relaxed );
+			const auto result =
+				( ( a < seen ) && ( b < seen ) )
+					? std::pair{ get( a ).ranks[set].load( std::memory_order_relaxed ),
+								 get( b ).ranks[set].load( std::memory_order_relaxed ) }
+					: std::pair{ npos, npos };
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if ( generation.load( std::memory_order_relaxed ) == g ) {
+				return result;
+			};
+		};
+	};
+
+	mutable std::shared_mutex mutex;
+	std::array< std::unique_ptr< slot[] >, chunk_count > owned;
+	std::array< std::atomic< slot * >, chunk_count > chunks{};
+	std::atomic< std::size_t > count{ 0 };
+	std::atomic< std::uint64_t > generation{ 0 };
+	std::array< std::atomic< std::size_t >, 2 > ranked{};
+	std::unordered_map< key, id_type, key_hash > index;
+}; // class fraction_pool
+
+}; // namespace mth
+
+#endif
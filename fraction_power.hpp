@@ -0,0 +1,181 @@
+/*
+ * fraction_power.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Exact perfect square and perfect cube tests for fractions, singly or over
+// a whole span, returning the root when there is one.
+// A fraction in lowest terms is a perfect power iff its numerator and
+// denominator both are. Each is first checked against tables of the
+// quadratic (cubic) residues of a few small moduli, which rejects about 99%
+// of non powers with a handful of multiplies:
+//   squares: mod 64, 63, 65, 11 (about 0.8% of non squares pass)
+//   cubes:   mod 63, 37, 19, 13 (about 0.7% of non cubes pass)
+// Survivors are checked with an exact integer root, so unlike is_abs_sq()
+// and is_cb() the result is exact over the whole range of INT.
+
+#ifndef FRACTION_POWER_HPP
+#define FRACTION_POWER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// Bit set of the residues mod M of x^power.
+template< unsigned M, unsigned power > struct residues {
+	static constexpr std::array< std::uint64_t, ( M + 63 ) / 64 > bits = [] {
+		std::array< std::uint64_t, ( M + 63 ) / 64 > result{};
+		for ( unsigned x = 0; x != M; ++x ) {
+			unsigned r = 1;
+			for ( unsigned i = 0; i != power; ++i ) {
+				r = r * x % M;
+			};
+			result[r / 64] |= std::uint64_t{ 1 } << ( r % 64 );
+		};
+		return result;
+	}();
+	[[nodiscard]] static constexpr bool contains( const std::uint64_t n ) noexcept {
+		const auto r = (unsigned)( n % M );
+		return ( ( bits[r / 64] >> ( r % 64 ) ) & 1 ) != 0;
+	};
+};
+
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr bool maybe_square( const U n ) noexcept {
+	return residues< 64, 2 >::contains( (std::uint64_t)( n & 63 ) ) &&
+		   residues< 63, 2 >::contains( (std::uint64_t)( n % 63 ) ) &&
+		   residues< 65, 2 >::contains( (std::uint64_t)( n % 65 ) ) &&
+		   residues< 11, 2 >::contains( (std::uint64_t)( n % 11 ) );
+};
+
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr bool maybe_cube( const U n ) noexcept {
+	return residues< 63, 3 >::contains( (std::uint64_t)( n % 63 ) ) &&
+		   residues< 37, 3 >::contains( (std::uint64_t)( n % 37 ) ) &&
+		   residues< 19, 3 >::contains( (std::uint64_t)( n % 19 ) ) &&
+		   residues< 13, 3 >::contains( (std::uint64_t)( n % 13 ) );
+};
+
+// floor(cbrt(n)), exact. The double estimate is corrected in integers.
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr U icbrt( const U n ) noexcept {
+	U r = (U)std::cbrt( (double)n );
+	while ( ( r != 0 ) && ( r * r > n / r ) ) {
+		--r;
+	};
+	while ( ( r + 1 ) * ( r + 1 ) <= n / ( r + 1 ) ) {
+		++r;
+	};
+	return r;
+};
+
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr std::optional< U > square_root( const U n ) noexcept {
+	if ( !maybe_square( n ) ) {
+		return std::nullopt;
+	};
+	const U r = isqrt( n );
+	return ( r * r == n ) ? std::optional< U >{ r } : std::nullopt;
+};
+
+template< std::unsigned_integral U >
+[[nodiscard]] constexpr std::optional< U > cube_root( const U n ) noexcept {
+	if ( !maybe_cube( n ) ) {
+		return std::nullopt;
+	};
+	const U r = icbrt( n );
+	return ( r * r * r == n ) ? std::optional< U >{ r } : std::nullopt;
+};
+
+}; // namespace detail
+
+// sqrt(abs(f)) if abs(f) is a perfect square, as per is_abs_sq().
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr std::optional< fraction< INT, error_exp > >
+abs_sq_root( const fraction< INT, error_exp > &f ) noexcept {
+	const auto num = detail::square_root( detail::uabs( f.num() ) );
+	if ( !num ) {
+		return std::nullopt;
+	};
+	const auto den = detail::square_root( detail::uabs( f.den() ) );
+	if ( !den ) {
+		return std::nullopt;
+	};
+	return fraction< INT, error_exp >::from_reduced( (INT)*num, (INT)*den );
+};
+
+// cbrt(f) if f is a perfect cube, as per is_cb().
+template< std::integral INT, int error_exp >
+[[nodiscard]] constexpr std::optional< fraction< INT, error_exp > >
+cb_root( const fraction< INT, error_exp > &f ) noexcept {
+	const auto num = detail::cube_root( detail::uabs( f.num() ) );
+	if ( !num ) {
+		return std::nullopt;
+	};
+	const auto den = detail::cube_root( detail::uabs( f.den() ) );
+	if ( !den ) {
+		return std::nullopt;
+	};
+	return fraction< INT, error_exp >::from_reduced(
+		f.is_neg() ? -(INT)*num : (INT)*num, (INT)*den );
+};
+
+// Batch versions. roots[i] is set to the root of from[i] or to nullopt.
+// Returns how many roots were found.
+template< std::integral INT, int error_exp >
+std::size_t
+abs_sq_roots( const std::span< const fraction< INT, error_exp > > from,
+			  const std::type_identity_t<
+				  std::span< std::optional< fraction< INT, error_exp > > > >
+				  roots ) noexcept {
+	std::size_t found = 0;
+	const std::size_t size = std::min( from.size(), roots.size() );
+	for ( std::size_t i = 0; i != size; ++i ) {
+		roots[i] = abs_sq_root( from[i] );
+		found += roots[i].has_value() ? 1 : 0;
+	};
+	return found;
+};
+template< std::integral INT, int error_exp >
+std::size_t
+cb_roots( const std::span< const fraction< INT, error_exp > > from,
+		  const std::type_identity_t<
+			  std::span< std::optional< fraction< INT, error_exp > > > >
+			  roots ) noexcept {
+	std::size_t found = 0;
+	const std::size_t size = std::min( from.size(), roots.size() );
+	for ( std::size_t i = 0; i != size; ++i ) {
+		roots[i] = cb_root( from[i] );
+		found += roots[i].has_value() ? 1 : 0;
+	};
+	return found;
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ * fraction_random.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Random fractions for tests, benchmarks and Monte Carlo. Every value is
+// built in lowest terms, so no gcd is taken.
+//   farey_distribution:       uniform over the Farey sequence F_n in (0, 1],
+//                             i.e. every reduced p/q with q <= n equally likely
+//   coprime_distribution:     uniform over the reduced fractions with a fixed
+//                             denominator in an integer range [lo, hi), by
+//                             rejecting numerators with a common factor
+//   log_uniform_distribution: log(q) uniform over 1 <= q <= n, then p/q
+//                             uniform over the reduced fractions in (0, 1]
+// A smallest prime factor sieve to n gives the distinct primes of any q <= n,
+// and from those the k-th integer coprime to q is found by inclusion-exclusion
+// and a binary search (select). farey_distribution numbers F_n by
+// denominator then numerator, with select() and its inverse rank().
+// The generator must give 64 uniform bits (e.g. std::mt19937_64). Bounded
+// integers use Lemire's multiply and shift with rejection, which is unbiased
+// and almost never divides. fill() writes a whole span.
+
+#ifndef FRACTION_RANDOM_HPP
+#define FRACTION_RANDOM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+template< typename G >
+concept uniform_random_64 =
+	std::uniform_random_bit_generator< G > && ( G::min() == 0 ) &&
+	( G::max() == std::numeric_limits< std::uint64_t >::max() );
+
+namespace detail {
+
+// Uniform in [0, range), range > 0.
+template< uniform_random_64 G >
+[[nodiscard]] std::uint64_t bounded( G &gen, const std::uint64_t range ) {
+	uint128_t product = (uint128_t)gen() * range;
+	if ( (std::uint64_t)product < range ) {
+		const std::uint64_t threshold = -range % range;
+		while ( (std::uint64_t)product < threshold ) {
+			product = (uint128_t)gen() * range;
+		};
+	};
+	return (std::uint64_t)( product >> 64 );
+};
+
+// Smallest prime factors to n, and the integers coprime to any q <= n.
+class coprime_sieve {
+  public:
+	// The square free divisors of q with the sign of the Mobius function.
+	struct divisors {
+		std::array< std::int64_t, 512 > signed_d{};
+		unsigned size = 0;
+	};
+
+	explicit coprime_sieve( const std::uint32_t n ) : spf( (std::size_t)n + 1, 0 ) {
+		for ( std::uint64_t i = 2; i <= n; ++i ) {
+			if ( spf[i] == 0 ) {
+				for ( std::uint64_t j = i; j <= n; j += i ) {
+					spf[j] = ( spf[j] == 0 ) ? (std::uint32_t)i : spf[j];
+				};
+			};
+		};
+	};
+
+	[[nodiscard]] divisors divisors_of( std::uint32_t q ) const noexcept {
+		divisors result;
+		result.signed_d[0] = 1;
+		result.size = 1;
+		while ( q > 1 ) {
+			const std::uint32_t p = spf[q];
+			while ( q % p == 0 ) {
+				q /= p;
+			};
+			for ( unsigned i = 0, size = result.size; i != size; ++i ) {
+				result.signed_d[result.size++] = -result.signed_d[i] * p;
+			};
+		};
+		return result;
+	};
+	// Euler's totient.
+	[[nodiscard]] static std::uint64_t totient( const std::uint32_t q,
+												const divisors &d ) noexcept {
+		return count( q, d );
+	};
+	// How many of 1 ... x are coprime to q.
+	[[nodiscard]] static std::uint64_t count( const std::uint64_t x,
+											  const divisors &d ) noexcept {
+		std::int64_t result = 0;
+		for ( unsigned i = 0; i != d.size; ++i ) {
+			const std::int64_t sd = d.signed_d[i];
+			result += ( sd < 0 ) ? -(std::int64_t)( x / (std::uint64_t)-sd )
+								 : (std::int64_t)( x / (std::uint64_t)sd );
+		};
+		return (std::uint64_t)result;
+	};
+	// The k-th (from 0) of 1 ... q coprime to q, k < totient(q).
+	[[nodiscard]] static std::uint32_t select( const std::uint32_t q,
+											   const std::uint64_t k,
+											   const divisors &d ) noexcept {
+		std::uint64_t lo = 1;
+		std::uint64_t hi = q;
+		while ( lo < hi ) {
+			const std::uint64_t mid = lo + ( hi - lo ) / 2;
+			if ( count( mid, d ) > k ) {
+				hi = mid;
+			} else {
+				lo = mid + 1;
+			};
+		};
+		return (std::uint32_t)lo;
+	};
+
+  private:
+	std::vector< std::uint32_t > spf;
+}; // class coprime_sieve
+
+}; // namespace detail
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class farey_distribution {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using result_type = fraction_type;
+
+	explicit farey_distribution( const std::uint32_t n )
+		: sieve{ n }, cumulative( (std::size_t)n + 1, 0 ) {
+		for ( std::uint32_t q = 1; q <= n; ++q ) {
+			cumulative[q] = cumulative[q - 1] +
+							sieve.totient( q, sieve.divisors_of( q ) );
+		};
+	};
+
+	// |F_n| less 0/1.
+	[[nodiscard]] std::uint64_t size() const noexcept { return cumulative.back(); };
+	// The k-th fraction, ordered by denominator then numerator, k < size().
+	[[nodiscard]] fraction_type select( const std::uint64_t k ) const noexcept {
+		const auto q = (std::uint32_t)( std::ranges::upper_bound( cumulative, k ) -
+										cumulative.begin() );
+		const std::uint32_t p = sieve.select( q, k - cumulative[q - 1],
+											  sieve.divisors_of( q ) );
+		return fraction_type::from_reduced( (INT)p, (INT)q );
+	};
+	// The inverse of select(), for f in F_n.
+	[[nodiscard]] std::uint64_t rank( const fraction_type &f ) const noexcept {
+		const auto q = (std::uint32_t)f.den();
+		return cumulative[q - 1] +
+			   sieve.count( (std::uint64_t)f.num(), sieve.divisors_of( q ) ) - 1;
+	};
+
+	template< uniform_random_64 G >
+	[[nodiscard]] fraction_type operator()( G &gen ) const {
+		return select( detail::bounded( gen, size() ) );
+	}
+	template< uniform_random_64 G >
+	void fill( G &gen, const std::span< fraction_type > to ) const {
+		for ( auto &f : to ) {
+			f = ( *this )( gen );
+		};
+	}
+
+  private:
+	detail::coprime_sieve sieve;
+	std::vector< std::uint64_t > cumulative;
+}; // class farey_distribution
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class coprime_distribution {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using result_type = fraction_type;
+
+	// Uniform over p/den in lowest terms with lo <= p/den < hi. Nothing unless
+	// den > 0 and lo < hi, with every such p fitting in INT and their count
+	// in 64 bits.
+	[[nodiscard]] static std::optional< coprime_distribution >
+	from_range( const INT den, const INT lo = 0, const INT hi = 1 ) {
+		INT first{};
+		INT last{};
+		std::uint64_t count{};
+		if ( ( den <= 0 ) || ( hi <= lo ) || __builtin_mul_overflow( lo, den, &first ) ||
+			 __builtin_mul_overflow( hi - 1, den, &last ) ||
+			 __builtin_add_overflow( last, den - 1, &last ) ||
+			 __builtin_mul_overflow( (std::uint64_t)hi - (std::uint64_t)lo,
+									 (std::uint64_t)den, &count ) ) {
+			return std::nullopt;
+		};
+		return coprime_distribution{ den, first, count };
+	};
+
+	// A numerator is drawn from all den * ( hi - lo ) and drawn again until
+	// it is coprime to den, den / totient( den ) times on average, which is
+	// below 8 for any 64 bit den.
+	template< uniform_random_64 G >
+	[[nodiscard]] fraction_type operator()( G &gen ) const {
+		using U = std::make_unsigned_t< INT >;
+		for ( ;; ) {
+			const std::uint64_t k = detail::bounded( gen, count );
+			if ( std::gcd( k % (std::uint64_t)denominator, (std::uint64_t)denominator ) ==
+				 1 ) {
+				return fraction_type::from_reduced( (INT)( (U)first + (U)k ), denominator );
+			};
+		};
+	}
+	template< uniform_random_64 G >
+	void fill( G &gen, const std::span< fraction_type > to ) const {
+		for ( auto &f : to ) {
+			f = ( *this )( gen );
+		};
+	}
+
+  private:
+	coprime_distribution( const INT den, const INT first, const std::uint64_t count )
+		: denominator{ den }, first{ first }, count{ count } {};
+
+	INT denominator;
+	INT first;
+	std::uint64_t count;
+}; // class coprime_distribution
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class log_uniform_distribution {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using result_type = fraction_type;
+
+	explicit log_uniform_distribution( const std::uint32_t n )
+		: sieve{ n }, max_den{ n }, log_n{ std::log( (double)n + 1.0 ) } {};
+
+	template< uniform_random_64 G >
+	[[nodiscard]] fraction_type operator()( G &gen ) const {
+		const double u = (double)( gen() >> 11 ) * 0x1.0p-53;
+		const auto q = std::clamp( (std::uint32_t)std::exp( u * log_n ),
+								   std::uint32_t{ 1 }, max_den );
+		const auto divisors = sieve.divisors_of( q );
+		const std::uint32_t p = sieve.select(
+			q, detail::bounded( gen, sieve.totient( q, divisors ) ), divisors );
+		return fraction_type::from_reduced( (INT)p, (INT)q );
+	}
+	template< uniform_random_64 G >
+	void fill( G &gen, const std::span< fraction_type > to ) const {
+		for ( auto &f : to ) {
+			f = ( *this )( gen );
+		};
+	}
+
+  private:
+	detail::coprime_sieve sieve;
+	std::uint32_t max_den;
+	double log_n;
+}; // class log_uniform_distribution
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,583 @@
+/*
+ * fraction_rational.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Rational functions p(x) / q(x) with fraction coefficients.
+// The coefficients of p and q are brought to integers by the common
+// denominator of all of them, which cancels, so arithmetic is integer
+// polynomial arithmetic with no gcd per coefficient. After each operation
+// only the integer content (the gcd of all the coefficients) is removed.
+// Common polynomial factors of p and q are left until p and q together have
+// more than cancel_size coefficients, or an operation overflows. Their gcd
+// is then found modulo a 61 bit prime, lifted back to the integers and
+// checked by dividing p and q by it exactly in widened integers.
+// Evaluation at x = a / b is Horner's rule on the homogenised polynomials,
+//   b^n * p( a / b ) = ( ... ( p_n * a + p_n-1 * b ) * a + ... ) + p_0 * b^n
+// in widened integers, with a single reduction of the result at the end.
+// An operation that overflows even after cancelling gives an invalid
+// function (valid() is false), which evaluates to nothing.
+
+#ifndef FRACTION_RATIONAL_HPP
+#define FRACTION_RATIONAL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_column.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// Polynomials as coefficients from the constant term up, with no trailing
+// zeros, so 0 is empty. Those returning bool return false on overflow.
+
+template< typename T > void poly_trim( std::vector< T > &p ) {
+	while ( !p.empty() && ( p.back() == 0 ) ) {
+		p.pop_back();
+	};
+};
+
+template< typename T >
+[[nodiscard]] bool poly_add( const std::vector< T > &a, const std::vector< T > &b,
+							 std::vector< T > &to ) {
+	to.assign( std::max( a.size(), b.size() ), 0 );
+	bool over = false;
+	for ( std::size_t i = 0; i != to.size(); ++i ) {
+		over |= __builtin_add_overflow( ( i < a.size() ) ? a[i] : 0,
+										( i < b.size() ) ? b[i] : 0, &to[i] );
+	};
+	poly_trim( to );
+	return !over;
+};
+
+template< typename T >
+[[nodiscard]] bool poly_negate( const std::vector< T > &a, std::vector< T > &to ) {
+	to.resize( a.size() );
+	bool over = false;
+	for ( std::size_t i = 0; i != a.size(); ++i ) {
+		over |= __builtin_sub_overflow( T{ 0 }, a[i], &to[i] );
+	};
+	return !over;
+};
+
+template< typename T >
+[[nodiscard]] bool poly_mul( const std::vector< T > &a, const std::vector< T > &b,
+							 std::vector< T > &to ) {
+	if ( a.empty() || b.empty() ) {
+		to.clear();
+		return true;
+	};
+	to.assign( a.size() + b.size() - 1, 0 );
+	bool over = false;
+	for ( std::size_t i = 0; i != a.size(); ++i ) {
+		for ( std::size_t j = 0; j != b.size(); ++j ) {
+			T product;
+			over |= __builtin_mul_overflow( a[i], b[j], &product );
+			over |= __builtin_add_overflow( to[i + j], product, &to[i + j] );
+		};
+	};
+	return !over;
+};
+
+// Divide by the gcd of the coefficients and make the leading one positive.
+template< typename T > [[nodiscard]] bool poly_primitive( std::vector< T > &p ) {
+	using U = widened_unsigned_t< T >;
+	U content = 0;
+	for ( const T c : p ) {
+		content = binary_gcd( content, ( c < 0 ) ? (U)0 - (U)c : (U)c );
+	};
+	if ( p.empty() ) {
+		return true;
+	};
+	// Only when every coefficient is the most negative T is content too big
+	// for T, then the conversion wraps to that and each becomes 1.
+	const T divisor = (T)content;
+	for ( T &c : p ) {
+		c /= divisor;
+	};
+	return ( p.back() > 0 ) || poly_negate( p, p );
+};
+
+// Arithmetic modulo the prime 2^61 - 1.
+inline constexpr std::uint64_t gcd_prime = ( std::uint64_t{ 1 } << 61 ) - 1;
+
+[[nodiscard]] constexpr std::uint64_t mul_mod( const std::uint64_t a,
+											   const std::uint64_t b ) noexcept {
+	return (std::uint64_t)( (uint128_t)a * b % gcd_prime );
+};
+
+// a^-1 as a^(p - 2).
+[[nodiscard]] constexpr std::uint64_t inv_mod( std::uint64_t a ) noexcept {
+	std::uint64_t result = 1;
+	for ( std::uint64_t e = gcd_prime - 2; e != 0; e >>= 1 ) {
+		if ( ( e & 1 ) != 0 ) {
+			result = mul_mod( result, a );
+		};
+		a = mul_mod( a, a );
+	};
+	return result;
+};
+
+// The monic gcd of a and b modulo gcd_prime, by Euclid's algorithm.
+[[nodiscard]] inline std::vector< std::uint64_t >
+poly_gcd_mod( std::vector< std::uint64_t > a, std::vector< std::uint64_t > b ) {
+	while ( !b.empty() ) {
+		const std::uint64_t inverse = inv_mod( b.back() );
+		while ( a.size() >= b.size() ) {
+			const std::size_t shift = a.size() - b.size();
+			const std::uint64_t factor = mul_mod( a.back(), inverse );
+			for ( std::size_t i = 0; i != b.size(); ++i ) {
+				a[i + shift] = ( a[i + shift] + gcd_prime - mul_mod( factor, b[i] ) ) %
+							   gcd_prime;
+			};
+			poly_trim( a );
+		};
+		std::swap( a, b );
+	};
+	const std::uint64_t inverse = inv_mod( a.back() );
+	for ( auto &c : a ) {
+		c = mul_mod( c, inverse );
+	};
+	return a;
+};
+
+// A candidate for the gcd of a and b, which are not 0: their gcd modulo
+// gcd_prime, times the gcd of their leading coefficients (which the leading
+// coefficient of the true gcd divides), lifted to the integers between
+// -gcd_prime / 2 and gcd_prime / 2 and made primitive. It is the gcd unless
+// the prime was unlucky or the coefficients too big, which dividing a and b
+// by it shows. false if the leading coefficients vanish modulo the prime.
+template< typename T >
+[[nodiscard]] bool poly_gcd( std::vector< T > a, std::vector< T > b,
+							 std::vector< T > &to ) {
+	using U = widened_unsigned_t< T >;
+	const auto reduce = []( const std::vector< T > &from ) {
+		std::vector< std::uint64_t > result( from.size() );
+		for ( std::size_t i = 0; i != from.size(); ++i ) {
+			const T c = from[i] % (T)gcd_prime;
+			result[i] = (std::uint64_t)( ( c < 0 ) ? c + (T)gcd_prime : c );
+		};
+		return result;
+	};
+	if ( !poly_primitive( a ) || !poly_primitive( b ) ) {
+		return false;
+	};
+	const auto a_mod = reduce( a );
+	const auto b_mod = reduce( b );
+	if ( ( a_mod.back() == 0 ) || ( b_mod.back() == 0 ) ) {
+		return false;
+	};
+	const auto g = poly_gcd_mod( a_mod, b_mod );
+	const std::uint64_t scale =
+		(std::uint64_t)( binary_gcd( (U)a.back(), (U)b.back() ) % gcd_prime );
+	to.resize( g.size() );
+	for ( std::size_t i = 0; i != g.size(); ++i ) {
+		const std::uint64_t c = mul_mod( g[i], scale );
+		to[i] = ( c > gcd_prime / 2 ) ? (T)c - (T)gcd_prime : (T)c;
+	};
+	return poly_primitive( to );
+};
+
+// a / d where d divides a, with a positive leading coefficient.
+template< typename T >
+[[nodiscard]] bool poly_divide_exact( std::vector< T > a, const std::vector< T > &d,
+									  std::vector< T > &to ) {
+	if ( a.empty() ) {
+		to.clear();
+		return true;
+	};
+	if ( d.empty() || ( a.size() < d.size() ) ) {
+		return false;
+	};
+	to.assign( a.size() - d.size() + 1, 0 );
+	bool over = false;
+	for ( std::size_t k = to.size(); k-- != 0; ) {
+		const T lead = a[k + d.size() - 1];
+		if ( lead % d.back() != 0 ) {
+			return false;
+		};
+		to[k] = lead / d.back();
+		for ( std::size_t j = 0; j != d.size(); ++j ) {
+			T product;
+			over |= __builtin_mul_overflow( to[k], d[j], &product );
+			over |= __builtin_sub_overflow( a[k + j], product, &a[k + j] );
+		};
+	};
+	return !over && std::ranges::all_of( a, []( const T c ) { return c == 0; } );
+};
+
+// b^n * p( a / b ) with n the degree of p.
+template< typename T, std::integral INT >
+[[nodiscard]] bool poly_horner( const std::vector< INT > &p, const T a, const T b,
+								T &to ) noexcept {
+	to = 0;
+	if ( p.empty() ) {
+		return true;
+	};
+	to = p.back();
+	T power = 1;
+	bool over = false;
+	for ( std::size_t i = p.size() - 1; i-- != 0; ) {
+		T term;
+		over |= __builtin_mul_overflow( power, b, &power );
+		over |= __builtin_mul_overflow( to, a, &to );
+		over |= __builtin_mul_overflow( (T)p[i], power, &term );
+		over |= __builtin_add_overflow( to, term, &to );
+	};
+	return !over;
+};
+
+}; // namespace detail
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class rational_function {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	// Integer coefficients from the constant term up.
+	using polynomial = std::vector< INT >;
+
+	// Cancel common factors once the numerator and denominator together have
+	// more than this many coefficients.
+	static constexpr std::size_t cancel_size = 8;
+
+	// 0.
+	rational_function() : q{ 1 } {};
+	// A constant, invalid for f_inf.
+	explicit rational_function( const fraction_type &c ) {
+		if ( c.den() != 0 ) {
+			p = { c.num() };
+			q = { c.den() };
+			normalise();
+		};
+	};
+	// x.
+	[[nodiscard]] static rational_function variable() {
+		rational_function result;
+		result.p = { 0, 1 };
+		return result;
+	};
+	// Coefficients from the constant term up. Nothing if the denominator is
+	// 0, a coefficient is infinite or the common denominator overflows INT.
+	[[nodiscard]] static std::optional< rational_function >
+	from_coefficients( const std::span< const fraction_type > num,
+					   const std::span< const fraction_type > den ) {
+		INT shared = 1;
+		for ( const auto part : { num, den } ) {
+			for ( const auto &c : part ) {
+				if ( c.den() == 0 ) {
+					return std::nullopt;
+				};
+				if ( shared % c.den() != 0 ) {
+					const auto lcm =
+						detail::checked_mul( shared / std::gcd( shared, c.den() ), c.den() );
+					if ( !lcm ) {
+						return std::nullopt;
+					};
+					shared = *lcm;
+				};
+			};
+		};
+		rational_function result;
+		for ( const auto &[from, to] : { std::pair{ num, &result.p },
+										 std::pair{ den, &result.q } } ) {
+			to->resize( from.size() );
+			for ( std::size_t i = 0; i != from.size(); ++i ) {
+				const auto c = detail::checked_mul( from[i].num(), shared / from[i].den() );
+				if ( !c ) {
+					return std::nullopt;
+				};
+				( *to )[i] = *c;
+			};
+			detail::poly_trim( *to );
+		};
+		if ( result.q.empty() ) {
+			return std::nullopt;
+		};
+		if ( !result.normalise() ) {
+			return std::nullopt;
+		};
+		result.maybe_cancel();
+		return result;
+	};
+
+	[[nodiscard]] bool valid() const noexcept { return !q.empty(); };
+	[[nodiscard]] const polynomial &numerator() const noexcept { return p; };
+	[[nodiscard]] const polynomial &denominator() const noexcept { return q; };
+
+	// Cancel all common factors of the numerator and denominator, leaving the
+	// function in lowest terms. Left as it is if that overflows.
+	void cancel() {
+		if ( !valid() || ( q.size() == 1 ) || p.empty() ) {
+			return;
+		};
+		std::vector< wide > wide_p( p.begin(), p.end() );
+		std::vector< wide > wide_q( q.begin(), q.end() );
+		std::vector< wide > common;
+		if ( !detail::poly_gcd( wide_p, wide_q, common ) || ( common.size() == 1 ) ) {
+			return;
+		};
+		if ( !detail::poly_divide_exact( wide_p, common, wide_p ) ||
+			 !detail::poly_divide_exact( wide_q, common, wide_q ) ) {
+			return;
+		};
+		polynomial new_p( wide_p.size() );
+		polynomial new_q( wide_q.size() );
+		for ( const auto &[from, to] :
+			  { std::pair{ &wide_p, &new_p }, std::pair{ &wide_q, &new_q } } ) {
+			for ( std::size_t i = 0; i != from->size(); ++i ) {
+				( *to )[i] = (INT)( *from )[i];
+				if ( ( *to )[i] != ( *from )[i] ) {
+					return;
+				};
+			};
+		};
+		p = std::move( new_p );
+		q = std::move( new_q );
+		normalise();
+	};
+
+	// The value at x, nothing at a pole or on overflow.
+	[[nodiscard]] std::optional< fraction_type >
+	operator()( const fraction_type &x ) const {
+		if ( const auto result = evaluate( x ) ) {
+			return result;
+		};
+		// 0/0 may be a common factor that has not been cancelled yet.
+		rational_function lowest = *this;
+		lowest.cancel();
+		return lowest.evaluate( x );
+	};
+	// The values at each of xs. A value that is at a pole or overflows is set
+	// to 0/0. Returns the number of such values.
+	std::size_t evaluate( const std::span< const fraction_type > xs,
+						  fraction_soa< INT > &to ) const {
+		to.resize( xs.size() );
+		std::size_t failed = 0;
+		for ( std::size_t i = 0; i != xs.size(); ++i ) {
+			const auto value = ( *this )( xs[i] );
+			to.num[i] = value ? value->num() : 0;
+			to.den[i] = value ? value->den() : 0;
+			failed += value ? 0 : 1;
+		};
+		return failed;
+	};
+
+	[[nodiscard]] rational_function operator-() const {
+		rational_function result = *this;
+		if ( valid() && !detail::poly_negate( p, result.p ) ) {
+			result.q.clear();
+		};
+		return result;
+	};
+	rational_function &operator+=( const rational_function &rhs ) {
+		return *this = combine( *this, rhs, []( const auto &a, const auto &b, auto &to ) {
+			if ( a.q == b.q ) {
+				to.q = a.q;
+				return detail::poly_add( a.p, b.p, to.p );
+			};
+			polynomial left;
+			polynomial right;
+			return detail::poly_mul( a.p, b.q, left ) &&
+				   detail::poly_mul( b.p, a.q, right ) &&
+				   detail::poly_add( left, right, to.p ) &&
+				   detail::poly_mul( a.q, b.q, to.q );
+		} );
+	};
+	rational_function &operator-=( const rational_function &rhs ) {
+		return *this += -rhs;
+	};
+	rational_function &operator*=( const rational_function &rhs ) {
+		return *this = combine( *this, rhs, []( const auto &a, const auto &b, auto &to ) {
+			return detail::poly_mul( a.p, b.p, to.p ) &&
+				   detail::poly_mul( a.q, b.q, to.q );
+		} );
+	};
+	// Invalid when dividing by 0.
+	rational_function &operator/=( const rational_function &rhs ) {
+		return *this = combine( *this, rhs, []( const auto &a, const auto &b, auto &to ) {
+			return !b.p.empty() && detail::poly_mul( a.p, b.q, to.p ) &&
+				   detail::poly_mul( a.q, b.p, to.q );
+		} );
+	};
+	[[nodiscard]] friend rational_function operator+( rational_function lhs,
+													  const rational_function &rhs ) {
+		return lhs += rhs;
+	};
+	[[nodiscard]] friend rational_function operator-( rational_function lhs,
+													  const rational_function &rhs ) {
+		return lhs -= rhs;
+	};
+	[[nodiscard]] friend rational_function operator*( rational_function lhs,
+													  const rational_function &rhs ) {
+		return lhs *= rhs;
+	};
+	[[nodiscard]] friend rational_function operator/( rational_function lhs,
+													  const rational_function &rhs ) {
+		return lhs /= rhs;
+	};
+
+	// Equal as functions, compared in lowest terms.
+	[[nodiscard]] friend bool operator==( rational_function lhs,
+										  rational_function rhs ) {
+		lhs.cancel();
+		rhs.cancel();
+		return ( lhs.p == rhs.p ) && ( lhs.q == rhs.q );
+	};
+
+	// As "(p)/(q)", or "(p)" when q is 1, highest power first.
+	[[nodiscard]] std::string to_string() const noexcept( false ) {
+		if ( !valid() ) {
+			return "(invalid)";
+		};
+		const auto print = []( const polynomial &a ) {
+			std::string result{};
+			for ( std::size_t i = a.size(); i-- != 0; ) {
+				if ( a[i] == 0 ) {
+					continue;
+				};
+				if ( ( a[i] > 0 ) && !result.empty() ) {
+					result += '+';
+				};
+				if ( ( i == 0 ) || ( ( a[i] != 1 ) && ( a[i] != -1 ) ) ) {
+					result += std::to_string( a[i] );
+				} else if ( a[i] == -1 ) {
+					result += '-';
+				};
+				if ( i != 0 ) {
+					result += ( i == 1 ) ? "x" : "x^" + std::to_string( i );
+				};
+			};
+			return '(' + ( result.empty() ? "0" : result ) + ')';
+		};
+		return ( q == polynomial{ 1 } ) ? print( p ) : print( p ) + '/' + print( q );
+	};
+
+  private:
+	using wide = detail::widened_t< INT >;
+
+	// Remove the content and make the denominator's leading coefficient
+	// positive. false, leaving the function invalid, on overflow.
+	bool normalise() {
+		detail::poly_trim( p );
+		if ( p.empty() ) {
+			q = { 1 };
+			return true;
+		};
+		std::vector< INT > both{ p };
+		both.insert( both.end(), q.begin(), q.end() );
+		if ( !detail::poly_primitive( both ) ) {
+			q.clear();
+			return false;
+		};
+		std::copy_n( both.begin(), p.size(), p.begin() );
+		std::copy( both.begin() + (std::ptrdiff_t)p.size(), both.end(), q.begin() );
+		if ( q.back() < 0 ) {
+			if ( !detail::poly_negate( p, p ) || !detail::poly_negate( q, q ) ) {
+				q.clear();
+				return false;
+			};
+		};
+		return true;
+	};
+
+	void maybe_cancel() {
+		if ( p.size() + q.size() > cancel_size ) {
+			cancel();
+		};
+	};
+
+	// op( a, b, result ), retried in lowest terms if it overflows.
+	template< typename OP >
+	[[nodiscard]] static rational_function combine( const rational_function &a,
+													const rational_function &b,
+													const OP op ) {
+		rational_function result;
+		result.q.clear();
+		if ( !a.valid() || !b.valid() ) {
+			return result;
+		};
+		if ( !op( a, b, result ) ) {
+			rational_function lowest_a = a;
+			rational_function lowest_b = b;
+			lowest_a.cancel();
+			lowest_b.cancel();
+			if ( !op( lowest_a, lowest_b, result ) ) {
+				result.q.clear();
+				return result;
+			};
+		};
+		detail::poly_trim( result.q );
+		if ( result.q.empty() || !result.normalise() ) {
+			result.q.clear();
+			return result;
+		};
+		result.maybe_cancel();
+		return result;
+	}
+
+	// The value at x without cancelling, nothing for 0/0.
+	[[nodiscard]] std::optional< fraction_type >
+	evaluate( const fraction_type &x ) const noexcept {
+		if ( !valid() || ( x.den() == 0 ) ) {
+			return std::nullopt;
+		};
+		wide top;
+		wide bottom;
+		if ( !detail::poly_horner( p, (wide)x.num(), (wide)x.den(), top ) ||
+			 !detail::poly_horner( q, (wide)x.num(), (wide)x.den(), bottom ) ||
+			 ( bottom == 0 ) ) {
+			return std::nullopt;
+		};
+		// top / b^deg p over bottom / b^deg q.
+		const std::size_t p_degree = p.empty() ? 0 : p.size() - 1;
+		const std::size_t q_degree = q.size() - 1;
+		bool over = false;
+		for ( std::size_t i = p_degree; i < q_degree; ++i ) {
+			over |= __builtin_mul_overflow( top, (wide)x.den(), &top );
+		};
+		for ( std::size_t i = q_degree; i < p_degree; ++i ) {
+			over |= __builtin_mul_overflow( bottom, (wide)x.den(), &bottom );
+		};
+		if ( bottom < 0 ) {
+			over |= __builtin_sub_overflow( wide{ 0 }, top, &top );
+			over |= __builtin_sub_overflow( wide{ 0 }, bottom, &bottom );
+		};
+		INT num;
+		INT den;
+		if ( over || !detail::narrow_reduced( top, bottom, num, den ) ) {
+			return std::nullopt;
+		};
+		return fraction_type::from_reduced( num, den );
+	};
+
+	polynomial p;
+	polynomial q;
+}; // class rational_function
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * fraction_report.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Double to fraction conversion with a report of what it cost and achieved,
+// for choosing error_exp and a conversion method for a source of data:
+//   to_fraction_with_report() - the fraction, its absolute and relative
+//                               error, the number of iterations and why the
+//                               algorithm stopped
+//   conversion_summary        - the same over many conversions
+// Each method runs the same loop as the plain converter, counting its
+// steps, so the fraction is the one fraction( double ) or
+// to_fraction_using_continued_fractions() gives. A max_iterations limit
+// stops a Stern Brocot search that would take too long, and a double that
+// is not finite or does not fit in INT, for which the plain converters do
+// not return, is reported without converting it.
+
+#ifndef FRACTION_REPORT_HPP
+#define FRACTION_REPORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+enum class conversion_method {
+	stern_brocot,		// to_fraction_using_stern_brocot_with_mediants()
+	continued_fractions // to_fraction_using_continued_fractions()
+};
+
+enum class conversion_stop {
+	within_error,	 // within fraction::error of the double
+	iteration_limit, // ran out of iterations, the error may be larger
+	out_of_range	 // not finite or too large for INT, not converted
+};
+
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+struct conversion_report {
+	fraction< INT, error_exp > value{};
+	double absolute_error = 0.0; // | value - from |
+	double relative_error = 0.0; // absolute_error / | from |, 0 if from is 0
+	std::size_t iterations = 0;
+	conversion_method method = conversion_method::stern_brocot;
+	conversion_stop stop = conversion_stop::within_error;
+};
+
+// from as a fraction by method, with what it took. For continued fractions
+// max_iterations is continued_fraction_max_iter.
+template< std::integral INT = std::int64_t, int error_exp = -6,
+		  std::size_t continued_fraction_max_iter = 25 >
+[[nodiscard]] conversion_report< INT, error_exp >
+to_fraction_with_report( const double from,
+						 const conversion_method method = conversion_method::stern_brocot,
+						 const std::size_t max_iterations =
+							 std::numeric_limits< std::size_t >::max() ) noexcept {
+	conversion_report< INT, error_exp > report;
+	report.method = method;
+	if ( !std::isfinite( from ) ||
+		 ( std::abs( from ) >= (double)std::numeric_limits< INT >::max() ) ) {
+		report.stop = conversion_stop::out_of_range;
+		report.absolute_error = std::numeric_limits< double >::infinity();
+		report.relative_error = std::numeric_limits< double >::infinity();
+		return report;
+	};
+	bool within = false;
+	if ( method == conversion_method::stern_brocot ) {
+		within = detail::stern_brocot_search( from, report.value, max_iterations,
+											  &report.iterations );
+	} else {
+		std::array< INT, continued_fraction_max_iter > cf{ 0 };
+		within = detail::continued_fraction_terms< INT, error_exp >(
+			from, std::span< INT >{ cf }, &report.iterations );
+		report.value = to_fraction< INT, error_exp >( std::span< INT >{ cf } );
+	};
+	report.stop = within ? conversion_stop::within_error : conversion_stop::iteration_limit;
+	report.absolute_error = std::abs( report.value.to_double() - from );
+	report.relative_error =
+		( from == 0.0 ) ? 0.0 : report.absolute_error / std::abs( from );
+	return report;
+};
+
+// Totals over many conversions.
+template< std::integral INT = std::int64_t, int error_exp = -6 >
+class conversion_summary {
+  public:
+	void add( const conversion_report< INT, error_exp > &report ) noexcept {
+		++stops[(std::size_t)report.stop];
+		if ( report.stop == conversion_stop::out_of_range ) {
+			return;
+		};
+		++n;
+		total_iterations += report.iterations;
+		most_iterations = std::max( most_iterations, report.iterations );
+		total_absolute_error += report.absolute_error;
+		largest_absolute_error = std::max( largest_absolute_error, report.absolute_error );
+		largest_relative_error = std::max( largest_relative_error, report.relative_error );
+	};
+	conversion_summary &operator+=( const conversion_summary &rhs ) noexcept {
+		for ( std::size_t i = 0; i != stops.size(); ++i ) {
+			stops[i] += rhs.stops[i];
+		};
+		n += rhs.n;
+		total_iterations += rhs.total_iterations;
+		most_iterations = std::max( most_iterations, rhs.most_iterations );
+		total_absolute_error += rhs.total_absolute_error;
+		largest_absolute_error =
+			std::max( largest_absolute_error, rhs.largest_absolute_error );
+		largest_relative_error =
+			std::max( largest_relative_error, rhs.largest_relative_error );
+		return *this;
+	};
+
+	// Counts include every conversion, the rest only those converted.
+	[[nodiscard]] std::size_t count( const conversion_stop stop ) const noexcept {
+		return stops[(std::size_t)stop];
+	};
+	[[nodiscard]] std::size_t converted() const noexcept { return n; };
+	[[nodiscard]] std::uint64_t iterations() const noexcept { return total_iterations; };
+	[[nodiscard]] double mean_iterations() const noexcept {
+		return ( n == 0 ) ? 0.0 : (double)total_iterations / (double)n;
+	};
+	[[nodiscard]] std::size_t max_iterations() const noexcept { return most_iterations; };
+	[[nodiscard]] double mean_absolute_error() const noexcept {
+		return ( n == 0 ) ? 0.0 : total_absolute_error / (double)n;
+	};
+	[[nodiscard]] double max_absolute_error() const noexcept {
+		return largest_absolute_error;
+	};
+	[[nodiscard]] double max_relative_error() const noexcept {
+		return largest_relative_error;
+	};
+
+  private:
+	std::array< std::size_t, 3 > stops{};
+	std::size_t n = 0;
+	std::uint64_t total_iterations = 0;
+	std::size_t most_iterations = 0;
+	double total_absolute_error = 0.0;
+	double largest_absolute_error = 0.0;
+	double largest_relative_error = 0.0;
+}; // class conversion_summary
+
+// The summary of converting each of from by method.
+template< std::integral INT = std::int64_t, int error_exp = -6,
+		  std::size_t continued_fraction_max_iter = 25 >
+[[nodiscard]] conversion_summary< INT, error_exp >
+summarise_conversions( const std::span< const double > from,
+					   const conversion_method method = conversion_method::stern_brocot,
+					   const std::size_t max_iterations =
+						   std::numeric_limits< std::size_t >::max() ) noexcept {
+	conversion_summary< INT, error_exp > summary;
+	for ( const double d : from ) {
+		summary.add( to_fraction_with_report< INT, error_exp, continued_fraction_max_iter >(
+			d, method, max_iterations ) );
+	};
+	return summary;
+};
+
+}; // namespace mth
+
+#endif
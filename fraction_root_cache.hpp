@@ -0,0 +1,117 @@
+/*
+ * fraction_root_cache.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// The root_cache, a bounded cache of the square and cube parts of integers
+// shared by every fraction with the same INT, which simplify_sqrt() and
+// simplify_cbrt() consult outside constant evaluation. It is kept out of
+// fraction_core.hpp with the locks and hash map it needs.
+
+#ifndef FRACTION_ROOT_CACHE_HPP
+#define FRACTION_ROOT_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "fraction_core.hpp"
+
+FRACTION_EXPORT namespace mth {
+
+// A bounded cache of to_root_parts() shared by all fractions with the same
+// INT, consulted by simplify_sqrt() and simplify_cbrt(). It is split into
+// shards, each with its own lock, and a shard is emptied when it fills.
+template< std::integral INT > class root_cache {
+  public:
+	[[nodiscard]] static root_cache &instance() noexcept {
+		static root_cache cache;
+		return cache;
+	};
+
+	[[nodiscard]] root_parts< INT > parts( const INT i ) noexcept {
+		// Fibonacci hashing, in 64 bits whatever the width of std::size_t.
+		const std::uint64_t hash = std::hash< INT >{}( i );
+		shard &s = table[( hash * 0x9e3779b97f4a7c15ULL ) >> ( 64 - shard_bits )];
+		{
+			std::shared_lock lock{ s.mutex };
+			if ( const auto it = s.map.find( i ); it != s.map.end() ) {
+				hit_count.fetch_add( 1, std::memory_order_relaxed );
+				return it->second;
+			};
+		};
+		miss_count.fetch_add( 1, std::memory_order_relaxed );
+		const root_parts< INT > result = to_root_parts( i );
+		try {
+			std::unique_lock lock{ s.mutex };
+			if ( s.map.size() >= capacity.load( std::memory_order_relaxed ) /
+									 shards ) {
+				s.map.clear();
+			};
+			s.map.emplace( i, result );
+		} catch ( ... ) {
+			// Not cached, the result is still good.
+		};
+		return result;
+	};
+
+	// Number of lookups that were (not) found in the cache.
+	[[nodiscard]] std::uint64_t hits() const noexcept { return hit_count; };
+	[[nodiscard]] std::uint64_t misses() const noexcept { return miss_count; };
+	// Maximum number of integers held.
+	void set_capacity( const std::size_t size ) noexcept { capacity = size; };
+	void clear() noexcept {
+		for ( auto &s : table ) {
+			std::unique_lock lock{ s.mutex };
+			s.map.clear();
+		};
+		hit_count = 0;
+		miss_count = 0;
+	};
+
+  private:
+	static constexpr unsigned shard_bits = 4;
+	static constexpr std::size_t shards = std::size_t{ 1 } << shard_bits;
+	struct shard {
+		std::shared_mutex mutex;
+		std::unordered_map< INT, root_parts< INT > > map;
+	};
+
+	root_cache() = default;
+
+	std::array< shard, shards > table;
+	std::atomic< std::size_t > capacity{ 1 << 16 };
+	std::atomic< std::uint64_t > hit_count{ 0 };
+	std::atomic< std::uint64_t > miss_count{ 0 };
+}; // class root_cache
+
+template< std::integral INT >
+root_parts< INT > detail::cached_root_parts( const INT i ) noexcept {
+	return root_cache< INT >::instance().parts( i );
+};
+
+}; // namespace mth
+
+#endif
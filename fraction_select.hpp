@@ -0,0 +1,184 @@
+/*
+ * fraction_select.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Exact selection (nth_element, median and quantile) for ranges of
+// fractions in O(n) expected time, with nearly all comparisons in double.
+// The nth key of the to_double() values is found first (std::nth_element,
+// i.e. introselect). to_double() is within a few ulp of the exact value, so
+// only fractions whose keys are within a small band of that key can be out
+// of order. The range is partitioned by key into below, band and above and
+// only the band is then selected with the exact operator<=>. The neighbour
+// that median() and quantile() interpolate towards is found the same way,
+// the least (or greatest) key first and then the exact least of its band.
+// Each takes iterators or a range of fractions, or a fraction_view.
+
+#ifndef FRACTION_SELECT_HPP
+#define FRACTION_SELECT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// to_double() is within 3 ulp, leave plenty of room.
+[[nodiscard]] inline double select_band( const double key ) noexcept {
+	return 16.0 * std::numeric_limits< double >::epsilon() * std::abs( key );
+};
+
+// The key of x, a fraction or an element of a fraction_view read as one.
+template< typename F, typename X > [[nodiscard]] double select_key( const X &x ) noexcept {
+	return static_cast< const F & >( x ).to_double();
+};
+
+// As per std::min_element( first, last, cmp ) for cmp std::less<> (or
+// std::max_element for std::greater<>), comparing exactly only those whose
+// keys are within the band of the least (greatest) key.
+template< std::random_access_iterator It, typename Cmp >
+[[nodiscard]] It extreme_element( const It first, const It last, const Cmp cmp ) {
+	if ( first == last ) {
+		return last;
+	};
+	using fraction_type = std::iter_value_t< It >;
+	double key = select_key< fraction_type >( *first );
+	for ( It it = first + 1; it != last; ++it ) {
+		if ( const double k = select_key< fraction_type >( *it ); cmp( k, key ) ) {
+			key = k;
+		};
+	};
+	if ( !std::isfinite( key ) ) {
+		return std::min_element( first, last, cmp );
+	};
+	const double band = select_band( key );
+	It result = last;
+	for ( It it = first; it != last; ++it ) {
+		if ( ( std::abs( select_key< fraction_type >( *it ) - key ) <= band ) &&
+			 ( ( result == last ) || cmp( *it, *result ) ) ) {
+			result = it;
+		};
+	};
+	return result;
+};
+
+}; // namespace detail
+
+// As per std::nth_element.
+template< std::random_access_iterator It >
+void nth_element( const It first, const It nth, const It last ) {
+	if ( ( first == last ) || ( nth == last ) ) {
+		return;
+	};
+	using fraction_type = std::iter_value_t< It >;
+	std::vector< double > keys( (std::size_t)( last - first ) );
+	std::transform( first, last, keys.begin(), []( const auto &f ) {
+		return detail::select_key< fraction_type >( f );
+	} );
+	const auto key_nth = keys.begin() + ( nth - first );
+	std::nth_element( keys.begin(), key_nth, keys.end() );
+	const double key = *key_nth;
+	if ( !std::isfinite( key ) ) {
+		std::nth_element( first, nth, last );
+		return;
+	};
+	const double band = detail::select_band( key );
+	const It below = std::partition( first, last, [&]( const auto &f ) {
+		return detail::select_key< fraction_type >( f ) < key - band;
+	} );
+	const It above = std::partition( below, last, [&]( const auto &f ) {
+		return detail::select_key< fraction_type >( f ) <= key + band;
+	} );
+	if ( ( below <= nth ) && ( nth < above ) ) {
+		std::nth_element( below, nth, above );
+	} else {
+		std::nth_element( first, nth, last );
+	};
+};
+
+// The q quantile, linearly interpolated between the two nearest elements
+// as per type 7 in Hyndman and Fan. Nothing for an empty range or q outside
+// [0, 1]. Reorders the range.
+template< std::random_access_iterator It >
+[[nodiscard]] std::optional< std::iter_value_t< It > >
+quantile( const It first, const It last,
+		  const std::type_identity_t< std::iter_value_t< It > > &q ) {
+	using fraction_type = std::iter_value_t< It >;
+	const auto size = last - first;
+	if ( ( size == 0 ) || ( q < fraction_type::f_0 ) || ( q > fraction_type::f_1 ) ) {
+		return std::nullopt;
+	};
+	const fraction_type h = q * (decltype( q.num() ))( size - 1 );
+	const auto index = h.num() / h.den();
+	const It nth = first + index;
+	mth::nth_element( first, nth, last );
+	const fraction_type part = h - index;
+	const fraction_type at_nth = *nth;
+	if ( ( part.num() == 0 ) || ( nth + 1 == last ) ) {
+		return at_nth;
+	};
+	const fraction_type next = *detail::extreme_element( nth + 1, last, std::less<>{} );
+	return at_nth + part * ( next - at_nth );
+};
+
+// The median, the mean of the middle two for an even size. Nothing for an
+// empty range, as for quantile(). Reorders the range.
+template< std::random_access_iterator It >
+[[nodiscard]] std::optional< std::iter_value_t< It > > median( const It first,
+															   const It last ) {
+	using fraction_type = std::iter_value_t< It >;
+	const auto size = last - first;
+	if ( size == 0 ) {
+		return std::nullopt;
+	};
+	const It nth = first + size / 2;
+	mth::nth_element( first, nth, last );
+	const fraction_type at_nth = *nth;
+	if ( size % 2 == 1 ) {
+		return at_nth;
+	};
+	const fraction_type below = *detail::extreme_element( first, nth, std::greater<>{} );
+	return ( below + at_nth ) / (decltype( at_nth.num() ))2;
+};
+
+// Range versions.
+template< std::ranges::random_access_range R >
+[[nodiscard]] std::optional< std::ranges::range_value_t< R > > median( R &&range ) {
+	return mth::median( std::ranges::begin( range ), std::ranges::end( range ) );
+};
+template< std::ranges::random_access_range R >
+[[nodiscard]] std::optional< std::ranges::range_value_t< R > >
+quantile( R &&range,
+		  const std::type_identity_t< std::ranges::range_value_t< R > > &q ) {
+	return mth::quantile( std::ranges::begin( range ), std::ranges::end( range ),
+						  q );
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ * fraction_stats.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Exact running statistics of a stream of fractions (or pairs of fractions):
+// count, sum x, sum x^2, sum y, sum y^2 and sum xy. From these the exact
+// mean, variance and covariance are calculated on request.
+// Each sum is held over a common denominator in detail::widened_t< INT >
+// (__int128 for std::int64_t) and is not reduced while adding, so a term
+// with the same denominator as the sum costs one add and one multiply. A
+// sum is reduced only when the next term would not fit, and if even the
+// reduced sum cannot take it the accumulator is marked as overflowed. The
+// exact results are then nothing, as is any result that does not fit in
+// INT, rather than a value that has wrapped around.
+// Accumulators can be merged, so a large range, of fractions or through a
+// fraction_view, can be split across threads, see accumulate_stats().
+// The fractions added must be finite.
+
+#ifndef FRACTION_STATS_HPP
+#define FRACTION_STATS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_view.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// A sum of fractions held over a common (unreduced) positive denominator in
+// W, with every step checked for overflow. Once a step overflows, even
+// after reducing, the sum is overflowed for good.
+template< std::integral INT > struct lazy_sum {
+	using W = widened_t< INT >;
+	using U = widened_unsigned_t< W >;
+
+	W num = 0;
+	W den = 1;
+	bool overflowed = false;
+
+	// Add n / d, d > 0.
+	constexpr void add( const W n, const W d ) noexcept {
+		if ( !overflowed && !try_add( n, d ) ) {
+			reduce();
+			overflowed = !try_add( n, d );
+		};
+	};
+	// Add a * b / ( c * d ), c, d > 0.
+	constexpr void add_product( const W a, const W b, const W c, const W d ) noexcept {
+		W n{};
+		W m{};
+		if ( __builtin_mul_overflow( a, b, &n ) || __builtin_mul_overflow( c, d, &m ) ) {
+			overflowed = true;
+		} else {
+			add( n, m );
+		};
+	};
+	constexpr void add( const lazy_sum &rhs ) noexcept {
+		overflowed = overflowed || rhs.overflowed;
+		add( rhs.num, rhs.den );
+	};
+	constexpr void subtract( const lazy_sum &rhs ) noexcept {
+		W negated{};
+		overflowed = overflowed || rhs.overflowed ||
+					 __builtin_sub_overflow( W{ 0 }, rhs.num, &negated );
+		add( negated, rhs.den );
+	};
+
+	// This sum times rhs, and this sum divided by k > 0.
+	[[nodiscard]] constexpr lazy_sum times( lazy_sum rhs ) const noexcept {
+		lazy_sum result = *this;
+		result.overflowed = overflowed || rhs.overflowed;
+		result.reduce();
+		rhs.reduce();
+		// Cancel across before multiplying.
+		const W g1 = gcd( result.num, rhs.den );
+		const W g2 = gcd( rhs.num, result.den );
+		result.overflowed =
+			result.overflowed ||
+			__builtin_mul_overflow( result.num / g1, rhs.num / g2, &result.num ) ||
+			__builtin_mul_overflow( result.den / g2, rhs.den / g1, &result.den );
+		return result;
+	};
+	[[nodiscard]] constexpr lazy_sum divided_by( const W k ) const noexcept {
+		lazy_sum result = *this;
+		result.reduce();
+		const W g = gcd( result.num, k );
+		result.num /= g;
+		result.overflowed =
+			result.overflowed || __builtin_mul_overflow( result.den, k / g, &result.den );
+		return result;
+	};
+
+	// The sum in lowest terms, or nothing if it overflowed or does not fit
+	// in INT.
+	template< int error_exp >
+	[[nodiscard]] constexpr std::optional< fraction< INT, error_exp > >
+	value() const noexcept;
+	// NaN once overflowed.
+	[[nodiscard]] constexpr double to_double() const noexcept {
+		return overflowed ? std::numeric_limits< double >::quiet_NaN()
+						  : (double)num / (double)den;
+	};
+
+  private:
+	[[nodiscard]] static constexpr W gcd( const W a, const W b ) noexcept {
+		const W g = (W)binary_gcd( ( a < 0 ) ? (U)0 - (U)a : (U)a,
+								   ( b < 0 ) ? (U)0 - (U)b : (U)b );
+		return ( g == 0 ) ? 1 : g;
+	};
+	constexpr void reduce() noexcept {
+		const W g = gcd( num, den );
+		num /= g;
+		den /= g;
+	};
+	// Add n / d if it fits, leaving the sum as it was if not.
+	[[nodiscard]] constexpr bool try_add( const W n, const W d ) noexcept {
+		W new_num{};
+		W new_den = den;
+		W scaled{};
+		if ( d == den ) {
+			if ( __builtin_add_overflow( num, n, &new_num ) ) {
+				return false;
+			};
+		} else if ( den % d == 0 ) {
+			if ( __builtin_mul_overflow( n, den / d, &scaled ) ||
+				 __builtin_add_overflow( num, scaled, &new_num ) ) {
+				return false;
+			};
+		} else {
+			const W g = gcd( den, d );
+			W lhs{};
+			if ( __builtin_mul_overflow( num, d / g, &lhs ) ||
+				 __builtin_mul_overflow( n, den / g, &scaled ) ||
+				 __builtin_add_overflow( lhs, scaled, &new_num ) ||
+				 __builtin_mul_overflow( den, d / g, &new_den ) ) {
+				return false;
+			};
+		};
+		num = new_num;
+		den = new_den;
+		return true;
+	};
+};
+
+template< std::integral INT >
+template< int error_exp >
+constexpr std::optional< fraction< INT, error_exp > >
+lazy_sum< INT >::value() const noexcept {
+	INT n{};
+	INT d{};
+	if ( overflowed || !narrow_reduced( num, den, n, d ) ) {
+		return std::nullopt;
+	};
+	return fraction< INT, error_exp >::from_reduced( n, d );
+};
+
+}; // namespace detail
+
+template< typename T > class running_stats;
+
+template< std::integral INT, int error_exp >
+class running_stats< fraction< INT, error_exp > > {
+  public:
+	using fraction_type = fraction< INT, error_exp >;
+	using result_type = std::optional< fraction_type >;
+
+	// Add a value. Use either add( x ) or add( x, y ) on one accumulator.
+	constexpr void add( const fraction_type &x ) noexcept {
+		++n;
+		sx.add( x.num(), x.den() );
+		sxx.add_product( x.num(), x.num(), x.den(), x.den() );
+	};
+	// Add a pair for the covariance. The x statistics are kept as well.
+	constexpr void add( const fraction_type &x, const fraction_type &y ) noexcept {
+		add( x );
+		sy.add( y.num(), y.den() );
+		syy.add_product( y.num(), y.num(), y.den(), y.den() );
+		sxy.add_product( x.num(), y.num(), x.den(), y.den() );
+	};
+	// Combine with the statistics of another part of the stream.
+	constexpr running_stats &operator+=( const running_stats &rhs ) noexcept {
+		n += rhs.n;
+		sx.add( rhs.sx );
+		sxx.add( rhs.sxx );
+		sy.add( rhs.sy );
+		syy.add( rhs.syy );
+		sxy.add( rhs.sxy );
+		return *this;
+	};
+	constexpr void merge( const running_stats &rhs ) noexcept { *this += rhs; };
+
+	// True once a sum has overflowed, when the exact results are nothing.
+	[[nodiscard]] constexpr bool overflowed() const noexcept {
+		return sx.overflowed || sxx.overflowed || sy.overflowed || syy.overflowed ||
+			   sxy.overflowed;
+	};
+
+	// Exact results, nothing if a sum overflowed or the result does not fit
+	// in INT:
+	[[nodiscard]] constexpr std::uint64_t count() const noexcept { return n; };
+	[[nodiscard]] constexpr result_type sum() const noexcept {
+		return sx.template value< error_exp >();
+	};
+	[[nodiscard]] constexpr result_type sum_sq() const noexcept {
+		return sxx.template value< error_exp >();
+	};
+	[[nodiscard]] constexpr result_type mean() const noexcept {
+		return ( n == 0 ) ? fraction_type::f_0
+						  : sx.divided_by( (W)n ).template value< error_exp >();
+	};
+	[[nodiscard]] constexpr result_type mean_y() const noexcept {
+		return ( n == 0 ) ? fraction_type::f_0
+						  : sy.divided_by( (W)n ).template value< error_exp >();
+	};
+	// Population variance, sum((x - mean)^2) / n.
+	[[nodiscard]] constexpr result_type variance() const noexcept {
+		return moment( sx, sx, sxx, n );
+	};
+	[[nodiscard]] constexpr result_type variance_y() const noexcept {
+		return moment( sy, sy, syy, n );
+	};
+	// Sample variance, sum((x - mean)^2) / (n - 1).
+	[[nodiscard]] constexpr result_type sample_variance() const noexcept {
+		return ( n < 2 ) ? fraction_type::f_0 : moment( sx, sx, sxx, n - 1 );
+	};
+	// Population covariance, sum((x - mean x) * (y - mean y)) / n.
+	[[nodiscard]] constexpr result_type covariance() const noexcept {
+		return moment( sx, sy, sxy, n );
+	};
+	[[nodiscard]] constexpr result_type sample_covariance() const noexcept {
+		return ( n < 2 ) ? fraction_type::f_0 : moment( sx, sy, sxy, n - 1 );
+	};
+
+	// Approximate results in double, without reducing the sums. NaN once a
+	// sum has overflowed.
+	[[nodiscard]] constexpr double mean_d() const noexcept {
+		return ( n == 0 ) ? 0.0 : sx.to_double() / (double)n;
+	};
+	[[nodiscard]] constexpr double variance_d() const noexcept {
+		const double mean = mean_d();
+		return ( n == 0 ) ? 0.0 : sxx.to_double() / (double)n - mean * mean;
+	};
+	[[nodiscard]] constexpr double covariance_d() const noexcept {
+		return ( n == 0 ) ? 0.0
+						  : sxy.to_double() / (double)n -
+								mean_d() * sy.to_double() / (double)n;
+	};
+
+  private:
+	using W = detail::widened_t< INT >;
+
+	// ( sum ab - sum a * sum b / n ) / divisor, in W.
+	[[nodiscard]] constexpr result_type moment( const detail::lazy_sum< INT > &a,
+												const detail::lazy_sum< INT > &b,
+												const detail::lazy_sum< INT > &ab,
+												const std::uint64_t divisor ) const noexcept {
+		if ( n == 0 ) {
+			return fraction_type::f_0;
+		};
+		auto result = ab;
+		result.subtract( a.times( b ).divided_by( (W)n ) );
+		return result.divided_by( (W)divisor ).template value< error_exp >();
+	};
+
+	std::uint64_t n = 0;
+	detail::lazy_sum< INT > sx;
+	detail::lazy_sum< INT > sxx;
+	detail::lazy_sum< INT > sy;
+	detail::lazy_sum< INT > syy;
+	detail::lazy_sum< INT > sxy;
+}; // class running_stats
+
+namespace detail {
+
+// Statistics of from, a span of fractions or a fraction_view, split across
+// threads and merged.
+template< std::integral INT, int error_exp, typename R >
+[[nodiscard]] running_stats< fraction< INT, error_exp > >
+accumulate_stats( const R &from, std::size_t threads ) {
+	using stats_type = running_stats< fraction< INT, error_exp > >;
+	const std::size_t size = from.size();
+	threads = std::clamp< std::size_t >( threads, 1, std::max< std::size_t >( size, 1 ) );
+	std::vector< stats_type > parts( threads );
+	{
+		std::vector< std::jthread > workers;
+		for ( std::size_t i = 0; i != threads; ++i ) {
+			workers.emplace_back( [&, i] {
+				for ( std::size_t j = size * i / threads; j != size * ( i + 1 ) / threads;
+					  ++j ) {
+					parts[i].add( fraction< INT, error_exp >( from[j] ) );
+				};
+			} );
+		};
+	};
+	stats_type result;
+	for ( const auto &part : parts ) {
+		result += part;
+	};
+	return result;
+};
+
+}; // namespace detail
+
+// Statistics of a range, split across threads and merged.
+template< std::integral INT, int error_exp >
+[[nodiscard]] running_stats< fraction< INT, error_exp > >
+accumulate_stats( const std::span< const fraction< INT, error_exp > > from,
+				  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::accumulate_stats< INT, error_exp >( from, threads );
+};
+template< typename INT, int error_exp >
+[[nodiscard]] running_stats< fraction< std::remove_const_t< INT >, error_exp > >
+accumulate_stats( const fraction_view< INT, error_exp > from,
+				  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::accumulate_stats< std::remove_const_t< INT >, error_exp >( from, threads );
+};
+
+}; // namespace mth
+
+#endif
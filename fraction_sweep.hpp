@@ -0,0 +1,374 @@
+/*
+ * fraction_sweep.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Exact intersections of line segments with fraction end points, by the
+// Bentley-Ottmann sweep in the form given by de Berg et al., "Computational
+// Geometry", 2.1, which also handles end points on other segments, several
+// segments through one point, vertical and overlapping segments.
+// The sweep line moves left to right, points are ordered by x then y.
+// Every point, end point or intersection, is held as a sweep_point: x/w, y/w
+// with one shared positive denominator w, as wide_ints. An end point x, y
+// has w the product of its denominators, an intersection is the cross
+// product of the two lines, each the cross product of its end points. No
+// gcd is taken and nothing overflows.
+// The comparisons of points (event order) and of a point against a segment
+// (the status order) are first made in double, with an error bound, and
+// only made exactly when too close to call.
+// intersections() can split the plane into vertical slabs, one per thread,
+// each with an equal share of the start points. A slab sweeps the segments
+// that reach it and reports only the intersections within it.
+
+#ifndef FRACTION_SWEEP_HPP
+#define FRACTION_SWEEP_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_geometry.hpp"
+#include "fraction_wide.hpp"
+
+namespace mth {
+
+template< std::integral INT = std::int64_t, int error_exp = -6 > struct segment {
+	point2< INT, error_exp > a;
+	point2< INT, error_exp > b;
+};
+
+template< std::integral INT = std::int64_t > class sweep_point {
+  public:
+	// Room for x * w of one intersection times w of another.
+	using wide = wide_int_for< 16 * sizeof( INT ) * 8 >;
+
+	template< int error_exp >
+	explicit sweep_point( const point2< INT, error_exp > &p ) noexcept
+		: x{ wide{ p.x.num() } * wide{ p.y.den() } },
+		  y{ wide{ p.y.num() } * wide{ p.x.den() } },
+		  w{ wide{ p.x.den() } * wide{ p.y.den() } }, x_d{ p.x.to_double() },
+		  y_d{ p.y.to_double() } {}
+	// The homogeneous point x/w, y/w; w must not be 0.
+	sweep_point( const wide &x_, const wide &y_, const wide &w_ ) noexcept
+		: x{ w_.is_neg() ? -x_ : x_ }, y{ w_.is_neg() ? -y_ : y_ },
+		  w{ w_.abs() }, x_d{ x.to_double() / w.to_double() },
+		  y_d{ y.to_double() / w.to_double() } {};
+
+	// x_num() / den(), y_num() / den(), not reduced.
+	[[nodiscard]] const wide &x_num() const noexcept { return x; };
+	[[nodiscard]] const wide &y_num() const noexcept { return y; };
+	[[nodiscard]] const wide &den() const noexcept { return w; };
+	[[nodiscard]] double x_double() const noexcept { return x_d; };
+	[[nodiscard]] double y_double() const noexcept { return y_d; };
+	// The point as fractions, if both fit in INT.
+	template< int error_exp = -6 >
+	[[nodiscard]] std::optional< point2< INT, error_exp > > to_point() const {
+		const auto part = [&]( const wide &n ) {
+			const wide gcd_n = gcd( n, w );
+			const auto num = ( n / gcd_n ).template narrow< INT >();
+			const auto den = ( w / gcd_n ).template narrow< INT >();
+			return ( num && den ) ? std::optional{ fraction< INT, error_exp >::
+													   from_reduced( *num, *den ) }
+								  : std::nullopt;
+		};
+		const auto px = part( x );
+		const auto py = part( y );
+		return ( px && py ) ? std::optional{ point2< INT, error_exp >{ *px, *py } }
+							: std::nullopt;
+	}
+
+	// x order, then y.
+	[[nodiscard]] friend int compare_x( const sweep_point &lhs,
+										const sweep_point &rhs ) noexcept {
+		if ( const double diff = lhs.x_d - rhs.x_d;
+			 std::abs( diff ) >
+			 error * ( std::abs( lhs.x_d ) + std::abs( rhs.x_d ) ) ) {
+			return ( diff < 0.0 ) ? -1 : 1;
+		};
+		const auto order = lhs.x * rhs.w <=> rhs.x * lhs.w;
+		return ( order < 0 ) ? -1 : ( order > 0 ) ? 1 : 0;
+	};
+	[[nodiscard]] friend int compare( const sweep_point &lhs,
+									  const sweep_point &rhs ) noexcept {
+		if ( const int by_x = compare_x( lhs, rhs ); by_x != 0 ) {
+			return by_x;
+		};
+		if ( const double diff = lhs.y_d - rhs.y_d;
+			 std::abs( diff ) >
+			 error * ( std::abs( lhs.y_d ) + std::abs( rhs.y_d ) ) ) {
+			return ( diff < 0.0 ) ? -1 : 1;
+		};
+		const auto order = lhs.y * rhs.w <=> rhs.y * lhs.w;
+		return ( order < 0 ) ? -1 : ( order > 0 ) ? 1 : 0;
+	};
+	[[nodiscard]] friend bool operator<( const sweep_point &lhs,
+										 const sweep_point &rhs ) noexcept {
+		return compare( lhs, rhs ) < 0;
+	};
+	[[nodiscard]] friend bool operator==( const sweep_point &lhs,
+										  const sweep_point &rhs ) noexcept {
+		return compare( lhs, rhs ) == 0;
+	};
+	// The sign of the orientation of a, b, c, as per orient2d(). At most one
+	// of them may be an intersection.
+	[[nodiscard]] friend int orient( const sweep_point &a, const sweep_point &b,
+									 const sweep_point &c ) noexcept {
+		const double det = ( a.x_d - c.x_d ) * ( b.y_d - c.y_d ) -
+						   ( a.y_d - c.y_d ) * ( b.x_d - c.x_d );
+		const double permanent =
+			( std::abs( a.x_d ) + std::abs( c.x_d ) ) *
+				( std::abs( b.y_d ) + std::abs( c.y_d ) ) +
+			( std::abs( a.y_d ) + std::abs( c.y_d ) ) *
+				( std::abs( b.x_d ) + std::abs( c.x_d ) );
+		if ( std::abs( det ) > 4.0 * error * permanent ) {
+			return detail::sign_of( det );
+		};
+		return detail::det3( std::array< wide, 3 >{ a.x, a.y, a.w },
+							 std::array< wide, 3 >{ b.x, b.y, b.w },
+							 std::array< wide, 3 >{ c.x, c.y, c.w } )
+			.sign();
+	};
+	// The intersection of the lines through a, b and c, d, if they are not
+	// parallel.
+	[[nodiscard]] friend std::optional< sweep_point >
+	intersect( const sweep_point &a, const sweep_point &b, const sweep_point &c,
+			   const sweep_point &d ) noexcept {
+		const auto line = []( const sweep_point &p, const sweep_point &q ) {
+			return std::array< wide, 3 >{ p.y * q.w - p.w * q.y,
+										  p.w * q.x - p.x * q.w,
+										  p.x * q.y - p.y * q.x };
+		};
+		const auto l = line( a, b );
+		const auto m = line( c, d );
+		const wide w = l[0] * m[1] - l[1] * m[0];
+		if ( w.sign() == 0 ) {
+			return std::nullopt;
+		};
+		return sweep_point{ l[1] * m[2] - l[2] * m[1], l[2] * m[0] - l[0] * m[2],
+							w };
+	};
+
+  private:
+	// Relative error of the doubles, with to_double() of x and w each within
+	// the limbs of wide ulp, plenty of room.
+	static constexpr double error =
+		8.0 * ( 2 * sizeof( INT ) + 3 ) *
+		std::numeric_limits< double >::epsilon();
+
+	wide x;
+	wide y;
+	wide w;
+	double x_d;
+	double y_d;
+}; // class sweep_point
+
+template< std::integral INT = std::int64_t > struct intersection {
+	sweep_point< INT > point;
+	// Indexes of the segments through point, ascending.
+	std::vector< std::size_t > segments;
+};
+
+namespace detail {
+
+template< std::integral INT > class sweep {
+  public:
+	struct edge {
+		sweep_point< INT > start;
+		sweep_point< INT > end;
+		std::size_t index;
+		bool vertical;
+	};
+
+	explicit sweep( std::vector< edge > from ) : edges{ std::move( from ) } {
+		for ( std::size_t i = 0; i != edges.size(); ++i ) {
+			auto &at = queue.try_emplace( edges[i].start ).first->second;
+			( ( edges[i].start == edges[i].end ) ? at.points : at.starts )
+				.push_back( i );
+			queue.try_emplace( edges[i].end );
+		};
+	};
+
+	// Run the sweep, reporting the intersections with lo <= x < hi.
+	void run( const std::optional< sweep_point< INT > > &lo,
+			  const std::optional< sweep_point< INT > > &hi,
+			  std::vector< intersection< INT > > &to ) {
+		while ( !queue.empty() ) {
+			auto event = queue.extract( queue.begin() );
+			if ( hi && ( compare_x( event.key(), *hi ) >= 0 ) ) {
+				break;
+			};
+			handle( event.key(), event.mapped(),
+					!lo || ( compare_x( event.key(), *lo ) >= 0 ), to );
+		};
+	};
+
+  private:
+	struct event {
+		std::vector< std::size_t > starts;
+		// Segments of zero length.
+		std::vector< std::size_t > points;
+	};
+
+	// Where a segment in the status is at p.x: below (-1), through (0) or
+	// above (1) p.
+	[[nodiscard]] int side( const std::size_t i,
+							const sweep_point< INT > &p ) const noexcept {
+		const edge &e = edges[i];
+		if ( e.vertical ) {
+			return ( p < e.start ) ? 1 : ( e.end < p ) ? -1 : 0;
+		};
+		return -orient( e.start, e.end, p );
+	};
+
+	void handle( const sweep_point< INT > &p, const event &at, const bool report,
+				 std::vector< intersection< INT > > &to ) {
+		const auto lo = std::ranges::partition_point(
+			status, [&]( const std::size_t i ) { return side( i, p ) < 0; } );
+		const auto hi = std::partition_point(
+			lo, status.end(),
+			[&]( const std::size_t i ) { return side( i, p ) == 0; } );
+		if ( report && ( at.starts.size() + at.points.size() +
+							 (std::size_t)( hi - lo ) >
+						 1 ) ) {
+			intersection< INT > found{ p, {} };
+			for ( const auto list : { &at.starts, &at.points } ) {
+				for ( const auto i : *list ) {
+					found.segments.push_back( edges[i].index );
+				};
+			};
+			for ( auto i = lo; i != hi; ++i ) {
+				found.segments.push_back( edges[*i].index );
+			};
+			std::ranges::sort( found.segments );
+			to.push_back( std::move( found ) );
+		};
+		// Replace the segments through p with those that continue past it,
+		// in their order just after p.
+		std::vector< std::size_t > after = at.starts;
+		std::copy_if( lo, hi, std::back_inserter( after ),
+					  [&]( const std::size_t i ) { return !( edges[i].end == p ); } );
+		std::ranges::sort( after, [&]( const std::size_t i, const std::size_t j ) {
+			return orient( p, edges[i].end, edges[j].end ) > 0;
+		} );
+		const auto first = status.erase( lo, hi );
+		const auto index = (std::size_t)( first - status.begin() );
+		status.insert( first, after.begin(), after.end() );
+		if ( after.empty() ) {
+			if ( ( index != 0 ) && ( index != status.size() ) ) {
+				check( status[index - 1], status[index], p );
+			};
+		} else {
+			if ( index != 0 ) {
+				check( status[index - 1], status[index], p );
+			};
+			if ( const std::size_t last = index + after.size();
+				 last != status.size() ) {
+				check( status[last - 1], status[last], p );
+			};
+		};
+	};
+
+	// Queue the intersection of two segments if it is after p.
+	void check( const std::size_t i, const std::size_t j,
+				const sweep_point< INT > &p ) {
+		const edge &e = edges[i];
+		const edge &f = edges[j];
+		const auto q = intersect( e.start, e.end, f.start, f.end );
+		if ( q && ( p < *q ) && !( e.end < *q ) && !( f.end < *q ) &&
+			 !( *q < e.start ) && !( *q < f.start ) ) {
+			queue.try_emplace( *q );
+		};
+	};
+
+	std::vector< edge > edges;
+	std::map< sweep_point< INT >, event > queue;
+	// Segments crossing the sweep line, bottom to top.
+	std::vector< std::size_t > status;
+}; // class sweep
+
+}; // namespace detail
+
+// All the points where two or more of the segments meet, in x then y order.
+// Overlapping segments are reported at the end points within the overlap.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::vector< intersection< INT > >
+intersections( const std::span< const segment< INT, error_exp > > segments,
+			   std::size_t threads = std::thread::hardware_concurrency() ) {
+	using edge = typename detail::sweep< INT >::edge;
+	std::vector< edge > edges;
+	edges.reserve( segments.size() );
+	for ( std::size_t i = 0; i != segments.size(); ++i ) {
+		sweep_point< INT > a{ segments[i].a };
+		sweep_point< INT > b{ segments[i].b };
+		if ( b < a ) {
+			std::swap( a, b );
+		};
+		const bool vertical = ( compare_x( a, b ) == 0 );
+		edges.push_back( { std::move( a ), std::move( b ), i, vertical } );
+	};
+	std::ranges::sort( edges, []( const edge &lhs, const edge &rhs ) {
+		return lhs.start < rhs.start;
+	} );
+	// Slab i covers [ bounds[i], bounds[i + 1] ), bounded by start points.
+	threads = std::clamp< std::size_t >( threads, 1, std::max< std::size_t >(
+														  edges.size(), 1 ) );
+	std::vector< std::optional< sweep_point< INT > > > bounds{ std::nullopt };
+	for ( std::size_t i = 1; i != threads; ++i ) {
+		const auto &start = edges[edges.size() * i / threads].start;
+		if ( !bounds.back() || ( compare_x( *bounds.back(), start ) < 0 ) ) {
+			bounds.emplace_back( start );
+		};
+	};
+	bounds.emplace_back( std::nullopt );
+	std::vector< std::vector< intersection< INT > > > parts( bounds.size() - 1 );
+	{
+		std::vector< std::jthread > workers;
+		for ( std::size_t i = 0; i + 1 != bounds.size(); ++i ) {
+			workers.emplace_back( [&, i] {
+				const auto &lo = bounds[i];
+				const auto &hi = bounds[i + 1];
+				std::vector< edge > reach;
+				for ( const auto &e : edges ) {
+					if ( ( !lo || ( compare_x( e.end, *lo ) >= 0 ) ) &&
+						 ( !hi || ( compare_x( e.start, *hi ) < 0 ) ) ) {
+						reach.push_back( e );
+					};
+				};
+				detail::sweep< INT >{ std::move( reach ) }.run( lo, hi, parts[i] );
+			} );
+		};
+	};
+	std::vector< intersection< INT > > result;
+	for ( auto &part : parts ) {
+		std::ranges::move( part, std::back_inserter( result ) );
+	};
+	return result;
+};
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ * fraction_tree.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Sums, products and lowest common denominators of whole ranges, combined
+// pairwise in a balanced tree rather than folded left to right as
+// average() does. A left fold grows one operand while the other stays
+// small. In the tree, the operands at each level are of about the same
+// size, so the intermediate denominators stay as small as they can and an
+// overflow only happens when the result itself is close to overflowing.
+// Each step is exact in the widened integer, reduced, then checked back
+// into INT, so overflow gives nothing rather than a wrong result. Each
+// thread reduces an equal share of the range, of at least tree_share
+// elements, then the threads combine the shares in the same balanced way.
+// Each takes a span of fractions or a fraction_view.
+
+#ifndef FRACTION_TREE_HPP
+#define FRACTION_TREE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_view.hpp"
+
+namespace mth {
+
+namespace detail {
+
+// from[first, last) reduced pairwise by op, an optional< T >( T, T ), from
+// the leaves up. from is anything indexed by [] with elements that convert
+// to T, a span or a fraction_view. identity if the range is empty, nothing
+// if any op is nothing.
+template< typename T, typename R, typename OP >
+[[nodiscard]] std::optional< T > tree_reduce( const R &from, const std::size_t first,
+											  const std::size_t last, const T &identity,
+											  const OP &op ) {
+	if ( last - first <= 1 ) {
+		return ( first == last ) ? identity : T( from[first] );
+	};
+	const std::size_t middle = first + ( last - first ) / 2;
+	const auto left = tree_reduce( from, first, middle, identity, op );
+	if ( !left ) {
+		return std::nullopt;
+	};
+	const auto right = tree_reduce( from, middle, last, identity, op );
+	if ( !right ) {
+		return std::nullopt;
+	};
+	return op( *left, *right );
+};
+
+// The fewest elements a thread is given, below which starting it costs
+// more than it saves.
+inline constexpr std::size_t tree_share = 4096;
+
+// tree_reduce() of an equal share of from on each thread, then of the
+// shares, also across the threads. Once thread i has its share, for step
+// 1, 2, 4, ... while i is a multiple of 2 * step it waits for thread
+// i + step and combines that thread's result into its own, so the upper
+// levels are reduced in parallel too and thread 0 ends with the whole.
+template< typename T, typename R, typename OP >
+[[nodiscard]] std::optional< T > parallel_tree_reduce( const R &from, const T &identity,
+													   const OP &op, std::size_t threads ) {
+	const std::size_t size = from.size();
+	threads = std::clamp< std::size_t >( threads, 1,
+										 std::max< std::size_t >( size / tree_share, 1 ) );
+	if ( threads == 1 ) {
+		return tree_reduce( from, 0, size, identity, op );
+	};
+	std::vector< std::optional< T > > parts( threads );
+	std::vector< std::atomic< bool > > done( threads );
+	const auto work = [&]( const std::size_t i ) {
+		parts[i] = tree_reduce( from, size * i / threads, size * ( i + 1 ) / threads,
+								identity, op );
+		for ( std::size_t step = 1; ( i % ( 2 * step ) == 0 ) && ( i + step < threads );
+			  step *= 2 ) {
+			done[i + step].wait( false );
+			parts[i] = ( parts[i] && parts[i + step] ) ? op( *parts[i], *parts[i + step] )
+													   : std::nullopt;
+		};
+		done[i].store( true );
+		done[i].notify_one();
+	};
+	{
+		std::vector< std::jthread > workers;
+		for ( std::size_t i = 1; i != threads; ++i ) {
+			workers.emplace_back( work, i );
+		};
+		work( 0 );
+	};
+	return parts[0];
+};
+
+// a + b and a * b, exact or nothing.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+checked_add( const fraction< INT, error_exp > &a,
+			 const fraction< INT, error_exp > &b ) noexcept {
+	using wide = widened_t< INT >;
+	wide ad;
+	wide bc;
+	wide num;
+	wide den;
+	if ( __builtin_mul_overflow( (wide)a.num(), (wide)b.den(), &ad ) ||
+		 __builtin_mul_overflow( (wide)b.num(), (wide)a.den(), &bc ) ||
+		 __builtin_add_overflow( ad, bc, &num ) ||
+		 __builtin_mul_overflow( (wide)a.den(), (wide)b.den(), &den ) ) {
+		return std::nullopt;
+	};
+	INT n;
+	INT d;
+	if ( !narrow_reduced( num, den, n, d ) ) {
+		return std::nullopt;
+	};
+	return fraction< INT, error_exp >::from_reduced( n, d );
+};
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+checked_multiply( const fraction< INT, error_exp > &a,
+				  const fraction< INT, error_exp > &b ) noexcept {
+	using wide = widened_t< INT >;
+	wide num;
+	wide den;
+	if ( __builtin_mul_overflow( (wide)a.num(), (wide)b.num(), &num ) ||
+		 __builtin_mul_overflow( (wide)a.den(), (wide)b.den(), &den ) ) {
+		return std::nullopt;
+	};
+	INT n;
+	INT d;
+	if ( !narrow_reduced( num, den, n, d ) ) {
+		return std::nullopt;
+	};
+	return fraction< INT, error_exp >::from_reduced( n, d );
+};
+
+// true if no denominator is 0, as the tree cannot be exact with one.
+template< typename R > [[nodiscard]] bool all_finite( const R &from ) noexcept {
+	return std::none_of( from.begin(), from.end(),
+						 []( const auto &f ) { return f.den() == 0; } );
+};
+
+// tree_sum(), tree_product() and lcm_all() of a span of fractions or a
+// fraction_view, whose elements are reduced as they are read.
+template< std::integral INT, int error_exp, typename R >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+tree_sum( const R &from, const std::size_t threads ) {
+	if ( !all_finite( from ) ) {
+		return std::nullopt;
+	};
+	return parallel_tree_reduce( from, fraction< INT, error_exp >::f_0,
+								 checked_add< INT, error_exp >, threads );
+};
+template< std::integral INT, int error_exp, typename R >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+tree_product( const R &from, const std::size_t threads ) {
+	if ( !all_finite( from ) ) {
+		return std::nullopt;
+	};
+	return parallel_tree_reduce( from, fraction< INT, error_exp >::f_1,
+								 checked_multiply< INT, error_exp >, threads );
+};
+template< std::integral INT, int error_exp, typename R >
+[[nodiscard]] std::optional< INT > lcm_all( const R &from, const std::size_t threads ) {
+	if ( !all_finite( from ) ) {
+		return std::nullopt;
+	};
+	std::vector< INT > dens( from.size() );
+	std::transform( from.begin(), from.end(), dens.begin(), []( const auto &f ) {
+		return fraction< INT, error_exp >( f ).den();
+	} );
+	return parallel_tree_reduce(
+		std::span< const INT >{ dens }, INT{ 1 },
+		[]( const INT a, const INT b ) -> std::optional< INT > {
+			INT result;
+			if ( __builtin_mul_overflow( a / std::gcd( a, b ), b, &result ) ) {
+				return std::nullopt;
+			};
+			return result;
+		},
+		threads );
+};
+
+}; // namespace detail
+
+// The exact sum of from, nothing on overflow or if any is 1/0.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+tree_sum( const std::span< const fraction< INT, error_exp > > from,
+		  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::tree_sum< INT, error_exp >( from, threads );
+};
+template< typename INT, int error_exp >
+[[nodiscard]] std::optional< fraction< std::remove_const_t< INT >, error_exp > >
+tree_sum( const fraction_view< INT, error_exp > from,
+		  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::tree_sum< std::remove_const_t< INT >, error_exp >( from, threads );
+};
+
+// The exact product of from, nothing on overflow or if any is 1/0.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< fraction< INT, error_exp > >
+tree_product( const std::span< const fraction< INT, error_exp > > from,
+			  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::tree_product< INT, error_exp >( from, threads );
+};
+template< typename INT, int error_exp >
+[[nodiscard]] std::optional< fraction< std::remove_const_t< INT >, error_exp > >
+tree_product( const fraction_view< INT, error_exp > from,
+			  const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::tree_product< std::remove_const_t< INT >, error_exp >( from, threads );
+};
+
+// The least common multiple of the denominators of from, the lowest
+// denominator they can all share. Nothing on overflow or if any is 1/0.
+template< std::integral INT, int error_exp >
+[[nodiscard]] std::optional< INT >
+lcm_all( const std::span< const fraction< INT, error_exp > > from,
+		 const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::lcm_all< INT, error_exp >( from, threads );
+};
+template< typename INT, int error_exp >
+[[nodiscard]] std::optional< std::remove_const_t< INT > >
+lcm_all( const fraction_view< INT, error_exp > from,
+		 const std::size_t threads = std::thread::hardware_concurrency() ) {
+	return detail::lcm_all< std::remove_const_t< INT >, error_exp >( from, threads );
+};
+
+}; // namespace mth
+
+#endif
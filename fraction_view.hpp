@@ -0,0 +1,261 @@
+/*
+ * fraction_view.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// fraction_view, numerators and denominators held elsewhere (a fraction_soa,
+// an imported buffer, a mapped file) as a random access range of fractions,
+// without copying them into fractions first.
+// Reading an element makes the fraction from its numerator and denominator,
+// reducing it, or, for a view made with reduced = true, taking them as they
+// are with from_reduced(). Over non const INT an element can be assigned a
+// fraction, which stores its (reduced) numerator and denominator.
+// Elements are proxies, not fraction &. The iterator is a random access
+// iterator both for the std::ranges algorithms and, as with
+// std::vector< bool >, for the std:: ones, so over non const INT the view
+// can be sorted, merged and permuted by either, including stable_sort(),
+// inplace_merge(), rotate() and nth_element(). Those that swap elements
+// move the stored values as they are; those that move an element through a
+// temporary fraction store it back reduced.
+// tree_sum(), tree_product(), lcm_all(), accumulate_stats(),
+// histogram::fill(), median(), quantile(), to_fractions(), simplify_sqrts()
+// and simplify_cbrts() each take a view as well as fractions.
+//   std::vector< std::int64_t > nums, dens;
+//   mth::fraction_view view{ nums, dens };
+//   std::ranges::sort( view );
+
+#ifndef FRACTION_VIEW_HPP
+#define FRACTION_VIEW_HPP
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+// One element of a fraction_view, read as and assigned from a fraction.
+template< typename INT, int error_exp >
+	requires std::integral< std::remove_const_t< INT > >
+class fraction_view_reference {
+  public:
+	using fraction_type = fraction< std::remove_const_t< INT >, error_exp >;
+
+	constexpr fraction_view_reference( INT *const num, INT *const den,
+									   const bool reduced ) noexcept
+		: numerator{ num }, denominator{ den }, is_reduced{ reduced } {};
+	constexpr fraction_view_reference( const fraction_view_reference &from ) = default;
+
+	constexpr operator fraction_type() const noexcept {
+		return is_reduced ? fraction_type::from_reduced( *numerator, *denominator )
+						  : fraction_type{ *numerator, *denominator };
+	};
+	// The numerator and denominator as they are stored.
+	[[nodiscard]] constexpr INT &num() const noexcept { return *numerator; };
+	[[nodiscard]] constexpr INT &den() const noexcept { return *denominator; };
+
+	constexpr const fraction_view_reference &
+	operator=( const fraction_type &from ) const noexcept
+		requires( !std::is_const_v< INT > )
+	{
+		*numerator = from.num();
+		*denominator = from.den();
+		return *this;
+	}
+	constexpr const fraction_view_reference &
+	operator=( const fraction_view_reference &from ) const noexcept
+		requires( !std::is_const_v< INT > )
+	{
+		return *this = (fraction_type)from;
+	}
+	// Swaps the stored values without making fractions of them, for
+	// std::ranges::iter_swap() and std::iter_swap().
+	constexpr friend void swap( const fraction_view_reference &lhs,
+								const fraction_view_reference &rhs ) noexcept
+		requires( !std::is_const_v< INT > )
+	{
+		std::swap( *lhs.numerator, *rhs.numerator );
+		std::swap( *lhs.denominator, *rhs.denominator );
+	}
+
+	constexpr friend bool operator==( const fraction_view_reference &lhs,
+									  const fraction_view_reference &rhs ) {
+		return (fraction_type)lhs == (fraction_type)rhs;
+	};
+	constexpr friend bool operator==( const fraction_view_reference &lhs,
+									  const fraction_type &rhs ) {
+		return (fraction_type)lhs == rhs;
+	};
+	constexpr friend std::strong_ordering operator<=>( const fraction_view_reference &lhs,
+													   const fraction_view_reference &rhs ) {
+		return (fraction_type)lhs <=> (fraction_type)rhs;
+	};
+	constexpr friend std::strong_ordering operator<=>( const fraction_view_reference &lhs,
+													   const fraction_type &rhs ) {
+		return (fraction_type)lhs <=> rhs;
+	};
+
+  private:
+	INT *numerator;
+	INT *denominator;
+	bool is_reduced;
+}; // class fraction_view_reference
+
+template< typename INT = std::int64_t, int error_exp = -6 >
+	requires std::integral< std::remove_const_t< INT > >
+class fraction_view
+	: public std::ranges::view_interface< fraction_view< INT, error_exp > > {
+  public:
+	using fraction_type = fraction< std::remove_const_t< INT >, error_exp >;
+
+	using reference = fraction_view_reference< INT, error_exp >;
+
+	class iterator {
+	  public:
+		using iterator_concept = std::random_access_iterator_tag;
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = fraction_type;
+		using difference_type = std::ptrdiff_t;
+		using reference = fraction_view_reference< INT, error_exp >;
+		using pointer = void;
+
+		constexpr iterator() noexcept = default;
+		constexpr iterator( INT *const num, INT *const den, const bool reduced ) noexcept
+			: numerator{ num }, denominator{ den }, is_reduced{ reduced } {};
+
+		constexpr reference operator*() const noexcept {
+			return reference{ numerator, denominator, is_reduced };
+		};
+		constexpr reference operator[]( const difference_type n ) const noexcept {
+			return *( *this + n );
+		};
+
+		constexpr iterator &operator++() noexcept { return *this += 1; };
+		constexpr iterator operator++( int ) noexcept {
+			iterator result = *this;
+			++*this;
+			return result;
+		};
+		constexpr iterator &operator--() noexcept { return *this -= 1; };
+		constexpr iterator operator--( int ) noexcept {
+			iterator result = *this;
+			--*this;
+			return result;
+		};
+		constexpr iterator &operator+=( const difference_type n ) noexcept {
+			numerator += n;
+			denominator += n;
+			return *this;
+		};
+		constexpr iterator &operator-=( const difference_type n ) noexcept {
+			return *this += -n;
+		};
+		constexpr friend iterator operator+( iterator it, const difference_type n ) noexcept {
+			return it += n;
+		};
+		constexpr friend iterator operator+( const difference_type n, iterator it ) noexcept {
+			return it += n;
+		};
+		constexpr friend iterator operator-( iterator it, const difference_type n ) noexcept {
+			return it -= n;
+		};
+		constexpr friend difference_type operator-( const iterator &lhs,
+													const iterator &rhs ) noexcept {
+			return lhs.numerator - rhs.numerator;
+		};
+
+		constexpr friend bool operator==( const iterator &lhs, const iterator &rhs ) noexcept {
+			return lhs.numerator == rhs.numerator;
+		};
+		constexpr friend std::strong_ordering operator<=>( const iterator &lhs,
+														   const iterator &rhs ) noexcept {
+			return lhs.numerator <=> rhs.numerator;
+		};
+
+		constexpr friend fraction_type iter_move( const iterator &it ) noexcept {
+			return *it;
+		};
+
+	  private:
+		INT *numerator = nullptr;
+		INT *denominator = nullptr;
+		bool is_reduced = false;
+	}; // class iterator
+
+	constexpr fraction_view() noexcept = default;
+	// The first min( num.size(), den.size() ) of num over den. reduced asserts
+	// each is already in lowest terms with a positive denominator.
+	constexpr fraction_view( const std::span< INT > num, const std::span< INT > den,
+							 const bool reduced = false ) noexcept
+		: nums{ num.first( std::min( num.size(), den.size() ) ) },
+		  dens{ den.first( std::min( num.size(), den.size() ) ) }, is_reduced{ reduced } {};
+
+	[[nodiscard]] constexpr iterator begin() const noexcept {
+		return iterator{ nums.data(), dens.data(), is_reduced };
+	};
+	[[nodiscard]] constexpr iterator end() const noexcept {
+		return begin() + (std::ptrdiff_t)nums.size();
+	};
+	[[nodiscard]] constexpr std::size_t size() const noexcept { return nums.size(); };
+	[[nodiscard]] constexpr std::span< INT > num() const noexcept { return nums; };
+	[[nodiscard]] constexpr std::span< INT > den() const noexcept { return dens; };
+	[[nodiscard]] constexpr bool reduced() const noexcept { return is_reduced; };
+
+  private:
+	std::span< INT > nums;
+	std::span< INT > dens;
+	bool is_reduced = false;
+}; // class fraction_view
+
+template< std::ranges::contiguous_range R >
+fraction_view( R &&, R &&, bool = false )
+	-> fraction_view< std::remove_reference_t< std::ranges::range_reference_t< R > > >;
+
+}; // namespace mth
+
+// The view does not own the values, so its iterators outlive it.
+template< typename INT, int error_exp >
+inline constexpr bool
+	std::ranges::enable_borrowed_range< mth::fraction_view< INT, error_exp > > = true;
+
+// Elements are proxies that read as fractions.
+template< typename INT, int error_exp, template< class > class TQUAL,
+		  template< class > class UQUAL >
+struct std::basic_common_reference< mth::fraction_view_reference< INT, error_exp >,
+									mth::fraction< std::remove_const_t< INT >, error_exp >,
+									TQUAL, UQUAL > {
+	using type = mth::fraction< std::remove_const_t< INT >, error_exp >;
+};
+template< typename INT, int error_exp, template< class > class TQUAL,
+		  template< class > class UQUAL >
+struct std::basic_common_reference<
+	mth::fraction< std::remove_const_t< INT >, error_exp >,
+	mth::fraction_view_reference< INT, error_exp >, TQUAL, UQUAL > {
+	using type = mth::fraction< std::remove_const_t< INT >, error_exp >;
+};
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * fraction_wide.hpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// A fixed size signed integer of limbs 64 bit words, for exact results that
+// do not fit in INT. Arithmetic is two's complement modulo 2^(64 * limbs),
+// like the unsigned integers, so a sum of products is exact as long as the
+// final result fits, whatever the intermediate values.
+// Division is bit by bit and gcd is binary, both slow next to the other
+// operations and meant for the occasional final result.
+
+#ifndef FRACTION_WIDE_HPP
+#define FRACTION_WIDE_HPP
+
+#include <array>
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "fraction.hpp"
+
+namespace mth {
+
+template< std::size_t limbs > class wide_int {
+  public:
+	constexpr wide_int() noexcept = default;
+	template< typename T >
+		requires std::integral< T > || std::same_as< T, detail::int128_t >
+	constexpr wide_int( const T from ) noexcept {
+		const std::uint64_t fill = ( from < 0 ) ? ~std::uint64_t{ 0 } : 0;
+		for ( auto &limb : words ) {
+			limb = fill;
+		};
+		words[0] = (std::uint64_t)from;
+		if constexpr ( ( sizeof( T ) > 8 ) && ( limbs > 1 ) ) {
+			words[1] = (std::uint64_t)( from >> 64 );
+		};
+	}
+
+	[[nodiscard]] constexpr bool is_neg() const noexcept {
+		return (std::int64_t)words[limbs - 1] < 0;
+	};
+	[[nodiscard]] constexpr int sign() const noexcept {
+		if ( is_neg() ) {
+			return -1;
+		};
+		for ( const auto limb : words ) {
+			if ( limb != 0 ) {
+				return 1;
+			};
+		};
+		return 0;
+	};
+
+	constexpr wide_int &operator+=( const wide_int &rhs ) noexcept {
+		std::uint64_t carry = 0;
+		for ( std::size_t i = 0; i != limbs; ++i ) {
+			const detail::uint128_t sum =
+				(detail::uint128_t)words[i] + rhs.words[i] + carry;
+			words[i] = (std::uint64_t)sum;
+			carry = (std::uint64_t)( sum >> 64 );
+		};
+		return *this;
+	};
+	constexpr wide_int &operator-=( const wide_int &rhs ) noexcept {
+		return *this += -rhs;
+	};
+	// Multiplies the magnitudes, skipping their leading zero limbs.
+	constexpr wide_int &operator*=( const wide_int &rhs ) noexcept {
+		const wide_int u = abs();
+		const wide_int v = rhs.abs();
+		const std::size_t u_size = u.used();
+		const std::size_t v_size = v.used();
+		std::array< std::uint64_t, limbs > result{};
+		for ( std::size_t i = 0; i != u_size; ++i ) {
+			std::uint64_t carry = 0;
+			for ( std::size_t j = 0; ( j != v_size ) && ( i + j != limbs ); ++j ) {
+				const detail::uint128_t product =
+					(detail::uint128_t)u.words[i] * v.words[j] + result[i + j] +
+					carry;
+				result[i + j] = (std::uint64_t)product;
+				carry = (std::uint64_t)( product >> 64 );
+			};
+			if ( i + v_size < limbs ) {
+				result[i + v_size] = carry;
+			};
+		};
+		const bool negative = is_neg() != rhs.is_neg();
+		words = result;
+		if ( negative ) {
+			*this = -*this;
+		};
+		return *this;
+	};
+	[[nodiscard]] constexpr wide_int operator-() const noexcept {
+		wide_int result;
+		for ( std::size_t i = 0; i != limbs; ++i ) {
+			result.words[i] = ~words[i];
+		};
+		return result += wide_int{ 1 };
+	};
+	[[nodiscard]] friend constexpr wide_int operator+( wide_int lhs,
+													   const wide_int &rhs ) noexcept {
+		return lhs += rhs;
+	};
+	[[nodiscard]] friend constexpr wide_int operator-( wide_int lhs,
+													   const wide_int &rhs ) noexcept {
+		return lhs -= rhs;
+	};
+	[[nodiscard]] friend constexpr wide_int operator*( wide_int lhs,
+													   const wide_int &rhs ) noexcept {
+		return lhs *= rhs;
+	};
+
+	// Truncating, as for the built in integers.
+	[[nodiscard]] friend constexpr wide_int operator/( const wide_int &lhs,
+													   const wide_int &rhs ) noexcept {
+		return divide( lhs, rhs ).first;
+	};
+	[[nodiscard]] friend constexpr wide_int operator%( const wide_int &lhs,
+													   const wide_int &rhs ) noexcept {
+		return divide( lhs, rhs ).second;
+	};
+	[[nodiscard]] constexpr wide_int abs() const noexcept {
+		return is_neg() ? -*this : *this;
+	};
+	// The greatest common divisor, binary (Stein's) algorithm.
+	[[nodiscard]] friend constexpr wide_int gcd( wide_int a, wide_int b ) noexcept {
+		a = a.abs();
+		b = b.abs();
+		if ( a.sign() == 0 ) {
+			return b;
+		};
+		if ( b.sign() == 0 ) {
+			return a;
+		};
+		unsigned shift = 0;
+		for ( ; ( ( a.words[0] | b.words[0] ) & 1 ) == 0; ++shift ) {
+			a.shift_right();
+			b.shift_right();
+		};
+		while ( ( a.words[0] & 1 ) == 0 ) {
+			a.shift_right();
+		};
+		do {
+			while ( ( b.words[0] & 1 ) == 0 ) {
+				b.shift_right();
+			};
+			if ( a > b ) {
+				std::swap( a, b );
+			};
+			b -= a;
+		} while ( b.sign() != 0 );
+		for ( ; shift != 0; --shift ) {
+			a.shift_left();
+		};
+		return a;
+	};
+
+	[[nodiscard]] friend constexpr bool operator==( const wide_int &lhs,
+													const wide_int &rhs ) noexcept =
+		default;
+	[[nodiscard]] friend constexpr std::strong_ordering
+	operator<=>( const wide_int &lhs, const wide_int &rhs ) noexcept {
+		if ( const auto top = (std::int64_t)lhs.words[limbs - 1] <=>
+							  (std::int64_t)rhs.words[limbs - 1];
+			 top != 0 ) {
+			return top;
+		};
+		for ( std::size_t i = limbs - 1; i-- != 0; ) {
+			if ( lhs.words[i] != rhs.words[i] ) {
+				return lhs.words[i] <=> rhs.words[i];
+			};
+		};
+		return std::strong_ordering::equal;
+	};
+
+	// The low 64 bits as a signed integer.
+	[[nodiscard]] constexpr std::int64_t low() const noexcept {
+		return (std::int64_t)words[0];
+	};
+	// The value as T, if it fits.
+	template< std::integral T >
+	[[nodiscard]] constexpr std::optional< T > narrow() const noexcept {
+		const auto result = (T)low();
+		return ( wide_int{ result } == *this ) ? std::optional< T >{ result }
+											   : std::nullopt;
+	}
+	// Within 2 ulp, from the top three limbs.
+	[[nodiscard]] double to_double() const noexcept {
+		const wide_int magnitude = abs();
+		double result = 0.0;
+		for ( std::size_t i = magnitude.used(), last = ( i > 3 ) ? i - 3 : 0;
+			  i-- > last; ) {
+			result += std::ldexp( (double)magnitude.words[i], (int)( 64 * i ) );
+		};
+		return is_neg() ? -result : result;
+	};
+	[[nodiscard]] std::string to_string() const noexcept( false ) {
+		constexpr std::int64_t chunk = 1000000000000000000;
+		std::string result{};
+		wide_int rest = abs();
+		do {
+			const auto [quotient, remainder] = divide( rest, wide_int{ chunk } );
+			std::string digits = std::to_string( remainder.low() );
+			rest = quotient;
+			if ( rest.sign() != 0 ) {
+				digits.insert( 0, 18 - digits.size(), '0' );
+			};
+			result.insert( 0, digits );
+		} while ( rest.sign() != 0 );
+		return is_neg() ? '-' + result : result;
+	};
+
+  private:
+	// The number of limbs up to the highest non zero one.
+	[[nodiscard]] constexpr std::size_t used() const noexcept {
+		std::size_t size = limbs;
+		while ( ( size != 0 ) && ( words[size - 1] == 0 ) ) {
+			--size;
+		};
+		return size;
+	};
+	constexpr void shift_left() noexcept {
+		for ( std::size_t i = limbs; i-- != 1; ) {
+			words[i] = ( words[i] << 1 ) | ( words[i - 1] >> 63 );
+		};
+		words[0] <<= 1;
+	};
+	// Logical shift.
+	constexpr void shift_right() noexcept {
+		for ( std::size_t i = 0; i + 1 != limbs; ++i ) {
+			words[i] = ( words[i] >> 1 ) | ( words[i + 1] << 63 );
+		};
+		words[limbs - 1] >>= 1;
+	};
+	// Unsigned comparison.
+	[[nodiscard]] constexpr bool below( const wide_int &rhs ) const noexcept {
+		for ( std::size_t i = limbs; i-- != 0; ) {
+			if ( words[i] != rhs.words[i] ) {
+				return words[i] < rhs.words[i];
+			};
+		};
+		return false;
+	};
+	// Quotient and remainder, long division of the magnitudes.
+	[[nodiscard]] static constexpr std::pair< wide_int, wide_int >
+	divide( const wide_int &lhs, const wide_int &rhs ) noexcept {
+		const wide_int u = lhs.abs();
+		const wide_int v = rhs.abs();
+		wide_int quotient;
+		wide_int remainder;
+		for ( std::size_t bit = 64 * limbs; bit-- != 0; ) {
+			remainder.shift_left();
+			remainder.words[0] |= ( u.words[bit / 64] >> ( bit % 64 ) ) & 1;
+			if ( !remainder.below( v ) ) {
+				remainder -= v;
+				quotient.words[bit / 64] |= std::uint64_t{ 1 } << ( bit % 64 );
+			};
+		};
+		return { ( lhs.is_neg() != rhs.is_neg() ) ? -quotient : quotient,
+				 lhs.is_neg() ? -remainder : remainder };
+	};
+
+	std::array< std::uint64_t, limbs > words{};
+}; // class wide_int
+
+// A wide_int with at least bits bits.
+template< std::size_t bits > using wide_int_for = wide_int< ( bits + 63 ) / 64 >;
+
+}; // namespace mth
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * fractionbench.cpp
+ *
+ * Copyright 2023 Greg Lander<greg.j.lander@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+// Benchmarks of set(), the double converters and <=>, reporting per
+// operation the wall time and, on Linux, the hardware counters from
+// perf_event_open: cycles, instructions, branch misses and L1 data and last
+// level cache misses. Few instructions per cycle with few branch misses
+// points at division latency, many branch misses at the data dependent
+// loops. A counter the kernel will not give (no PMU, as in most virtual
+// machines, or perf_event_paranoid too high) is shown as "-", and the
+// wall time is always shown.
+// Each operation is run on random inputs and, where it has data dependent
+// loops, on inputs that make the loops predictable, to tell the two apart.
+//   g++ -std=c++2a -O2 fractionbench.cpp -o fractionbench
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "fraction.hpp"
+
+using Fraction = mth::fraction<>;
+
+// A set of independently opened counters, each of which may be missing.
+class perf_counters {
+  public:
+	static constexpr std::size_t size = 5;
+	static constexpr std::array< const char *, size > names{
+		"cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses" };
+
+	perf_counters() {
+#ifdef __linux__
+		const std::array< std::pair< std::uint32_t, std::uint64_t >, size > events{
+			std::pair{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+									  ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) |
+									  ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES } };
+		for ( std::size_t i = 0; i != size; ++i ) {
+			perf_event_attr attr;
+			std::memset( &attr, 0, sizeof( attr ) );
+			attr.size = sizeof( attr );
+			attr.type = events[i].first;
+			attr.config = events[i].second;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			// Scale for the time a counter was multiplexed out.
+			attr.read_format =
+				PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fds[i] = (int)syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 );
+		};
+#endif
+	};
+	perf_counters( const perf_counters & ) = delete;
+	perf_counters &operator=( const perf_counters & ) = delete;
+	~perf_counters() {
+#ifdef __linux__
+		for ( const int fd : fds ) {
+			if ( fd >= 0 ) {
+				close( fd );
+			};
+		};
+#endif
+	};
+
+	[[nodiscard]] bool any() const noexcept {
+		for ( const int fd : fds ) {
+			if ( fd >= 0 ) {
+				return true;
+			};
+		};
+		return false;
+	};
+	void start() noexcept {
+#ifdef __linux__
+		for ( const int fd : fds ) {
+			if ( fd >= 0 ) {
+				ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+				ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+			};
+		};
+#endif
+	};
+	// The counts since start(), nothing for a counter that is missing or
+	// never ran.
+	[[nodiscard]] std::array< std::optional< double >, size > stop() noexcept {
+		std::array< std::optional< double >, size > result{};
+#ifdef __linux__
+		for ( const int fd : fds ) {
+			if ( fd >= 0 ) {
+				ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+			};
+		};
+		for ( std::size_t i = 0; i != size; ++i ) {
+			std::array< std::uint64_t, 3 > value{}; // count, enabled, running
+			if ( ( fds[i] >= 0 ) &&
+				 ( read( fds[i], value.data(), sizeof( value ) ) ==
+				   (ssize_t)sizeof( value ) ) &&
+				 ( value[2] != 0 ) ) {
+				result[i] = (double)value[0] * (double)value[1] / (double)value[2];
+			};
+		};
+#endif
+		return result;
+	};
+
+  private:
+	std::array< int, size > fds{ -1, -1, -1, -1, -1 };
+}; // class perf_counters
+
+// Keeps results alive so the compiler cannot drop the work.
+volatile std::int64_t sink = 0;
+
+// Run op( i ) for i in [0, count), repeats times, and print the cost of
+// one op.
+template< typename OP >
+void bench( perf_counters &counters, const char *name, const std::size_t count,
+			const OP &op, const std::size_t repeats = 10 ) {
+	for ( std::size_t i = 0; i != count; ++i ) { // warm up
+		op( i );
+	};
+	counters.start();
+	const auto begin = std::chrono::steady_clock::now();
+	for ( std::size_t r = 0; r != repeats; ++r ) {
+		for ( std::size_t i = 0; i != count; ++i ) {
+			op( i );
+		};
+	};
+	const auto end = std::chrono::steady_clock::now();
+	const auto counts = counters.stop();
+	const double ops = (double)( count * repeats );
+	std::printf( "%-34s %9.2f", name,
+				 std::chrono::duration< double, std::nano >( end - begin ).count() /
+					 ops );
+	for ( const auto &c : counts ) {
+		if ( c ) {
+			std::printf( " %13.2f", *c / ops );
+		} else {
+			std::printf( " %13s", "-" );
+		};
+	};
+	if ( counts[0] && counts[1] ) {
+		std::printf( " %6.2f", *counts[1] / *counts[0] );
+	} else {
+		std::printf( " %6s", "-" );
+	};
+	std::printf( "\n" );
+};
+
+int main() {
+	constexpr std::size_t count = 1 << 14;
+	std::mt19937_64 random{ 1 };
+	std::uniform_int_distribution< std::int64_t > ints{ -1000000, 1000000 };
+	std::uniform_real_distribution< double > reals{ -100.0, 100.0 };
+
+	// Random numerators and denominators, and ones with a gcd of 1 where
+	// the gcd loop is the same length every time.
+	std::vector< std::int64_t > nums( count );
+	std::vector< std::int64_t > dens( count );
+	std::vector< std::int64_t > ones( count, 1 );
+	for ( std::size_t i = 0; i != count; ++i ) {
+		nums[i] = ints( random );
+		dens[i] = std::max< std::int64_t >( std::abs( ints( random ) ), 1 );
+	};
+	// Random doubles, and the same double over and over.
+	std::vector< double > doubles( count );
+	for ( auto &d : doubles ) {
+		d = reals( random );
+	};
+	const std::vector< double > repeated( count, 3.141592654 );
+	// Fractions to compare in random order and in sorted order, where the
+	// result of each comparison is the same as the last.
+	std::vector< Fraction > fractions( count + 1 );
+	for ( std::size_t i = 0; i != fractions.size(); ++i ) {
+		fractions[i] = Fraction{ ints( random ), std::max< std::int64_t >(
+													 std::abs( ints( random ) ), 1 ) };
+	};
+	std::vector< Fraction > sorted( fractions );
+	std::sort( sorted.begin(), sorted.end() );
+
+	perf_counters counters;
+	if ( !counters.any() ) {
+		std::printf( "No hardware counters (check perf_event_paranoid), wall time "
+					 "only.\n" );
+	};
+	std::printf( "%-34s %9s", "per op", "ns" );
+	for ( const char *name : perf_counters::names ) {
+		std::printf( " %13s", name );
+	};
+	std::printf( " %6s\n", "IPC" );
+
+	bench( counters, "set() random", count, [&]( const std::size_t i ) {
+		sink = sink + Fraction{ nums[i], dens[i] }.num();
+	} );
+	bench( counters, "set() den 1", count, [&]( const std::size_t i ) {
+		sink = sink + Fraction{ nums[i], ones[i] }.num();
+	} );
+	bench(
+		counters, "stern_brocot random", count,
+		[&]( const std::size_t i ) {
+			sink = sink + mth::to_fraction_using_stern_brocot_with_mediants( doubles[i] )
+							  .den();
+		},
+		1 );
+	bench(
+		counters, "stern_brocot repeated", count,
+		[&]( const std::size_t i ) {
+			sink =
+				sink +
+				mth::to_fraction_using_stern_brocot_with_mediants( repeated[i] ).den();
+		},
+		1 );
+	bench( counters, "continued_fractions random", count, [&]( const std::size_t i ) {
+		sink = sink + mth::to_fraction_using_continued_fractions( doubles[i] ).den();
+	} );
+	bench( counters, "continued_fractions repeated", count,
+		   [&]( const std::size_t i ) {
+			   sink = sink +
+					  mth::to_fraction_using_continued_fractions( repeated[i] ).den();
+		   } );
+	bench( counters, "<=> random", count, [&]( const std::size_t i ) {
+		sink = sink + ( ( fractions[i] <=> fractions[i + 1] ) < 0 );
+	} );
+	bench( counters, "<=> sorted", count, [&]( const std::size_t i ) {
+		sink = sink + ( ( sorted[i] <=> sorted[i + 1] ) < 0 );
+	} );
+
+	return 0;
+}
@@ -28,7 +28,91 @@
 #include <array>
 #include <vector>
 #include <cassert>
+#include <functional>
+#include <sstream>
+#include <charconv>
+#include <cstdlib>
+#include <new>
 #include "fraction.hpp"
+#include "fraction_pool.hpp"
+#include "fraction_column.hpp"
+#include "fraction_farey.hpp"
+#include "fraction_power.hpp"
+#include "fraction_stats.hpp"
+#include "fraction_select.hpp"
+#include "fraction_histogram.hpp"
+#include "fraction_random.hpp"
+#include "fraction_geometry.hpp"
+#include "fraction_sweep.hpp"
+#include "fraction_affine.hpp"
+#include "fraction_bezier.hpp"
+#include "fraction_rational.hpp"
+#include "fraction_lattice.hpp"
+#include "fraction_pipeline.hpp"
+#include "fraction_batch.hpp"
+#include "fraction_tree.hpp"
+#include "fraction_report.hpp"
+#include "fraction_arrow.hpp"
+#include "fraction_view.hpp"
+
+// Allocations made by this thread, counted by replacing the global
+// operator new and, on glibc without a sanitizer (which has its own),
+// malloc, calloc and realloc too.
+thread_local std::size_t allocations = 0;
+
+#if defined( __GLIBC__ ) && !defined( __SANITIZE_ADDRESS__ ) && \
+	!defined( __SANITIZE_THREAD__ )
+extern "C" {
+void *__libc_malloc( std::size_t size );
+void *__libc_calloc( std::size_t count, std::size_t size );
+void *__libc_realloc( void *p, std::size_t size );
+void *malloc( std::size_t size ) {
+	++allocations;
+	return __libc_malloc( size );
+};
+void *calloc( std::size_t count, std::size_t size ) {
+	++allocations;
+	return __libc_calloc( count, size );
+};
+void *realloc( void *p, std::size_t size ) {
+	++allocations;
+	return __libc_realloc( p, size );
+};
+};
+// malloc counts them.
+#define COUNT_NEW( size ) ( size )
+#else
+#define COUNT_NEW( size ) ( ++allocations, ( size ) )
+#endif
+
+void *operator new( std::size_t size ) {
+	if ( void *p = std::malloc( COUNT_NEW( std::max< std::size_t >( size, 1 ) ) ) ) {
+		return p;
+	};
+	throw std::bad_alloc{};
+};
+void *operator new[]( std::size_t size ) { return operator new( size ); };
+void *operator new( std::size_t size, const std::nothrow_t & ) noexcept {
+	return std::malloc( COUNT_NEW( std::max< std::size_t >( size, 1 ) ) );
+};
+void *operator new[]( std::size_t size, const std::nothrow_t &tag ) noexcept {
+	return operator new( size, tag );
+};
+// GCC cannot see that these pair with the operator new above.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete( void *p ) noexcept { std::free( p ); };
+void operator delete[]( void *p ) noexcept { std::free( p ); };
+void operator delete( void *p, std::size_t ) noexcept { std::free( p ); };
+void operator delete[]( void *p, std::size_t ) noexcept { std::free( p ); };
+#pragma GCC diagnostic pop
+
+// The number of allocations made by f().
+std::size_t allocations_in( const auto &f ) {
+	const std::size_t before = allocations;
+	f();
+	return allocations - before;
+};
 
 consteval auto compile_time(auto value)
 {
@@ -516,6 +600,883 @@ int main() {
 	Fraction t7((long)-NAN, 1);
 	Fraction t8(1, (long)-NAN);
 	std::cout << "Test: -NaN[" << t7.to_string() << "],1/-NaN:[" << t8.to_string() << "]\n";
-	
+
+	mth::fraction_pool pool;
+	std::array< mth::fraction_pool<>::id_type, f.size() > ids;
+	pool.intern( f, ids );
+	pool.sort();
+	std::cout << "fraction_pool: size="
+			  << check( std::to_string( pool.size() ), "17" ) << ",ids[15]="
+			  << check( std::to_string( ids[15] ), "15" ) << ",at(ids[4])="
+			  << check( pool.at( ids[4] ).to_string(), "(48/7)" )
+			  << ",rank(ids[7])="
+			  << check( std::to_string( pool.rank( ids[7] ) ), "0" )
+			  << ",ids[1]<ids[3]="
+			  << check( pool.compare( ids[1], ids[3] ) < 0 ? "true" : "false",
+						"true" )
+			  << ",find(5/7)="
+			  << check( pool.find( Fraction{ 5, 7 } ) ==
+								mth::fraction_pool<>::npos
+							? "npos"
+							: "found",
+						"npos" )
+			  << '\n';
+
+	// Lookups without a lock while another thread interns across several
+	// chunks and sorts. Ids are interned in order of value, so each is its
+	// own rank.
+	std::atomic< std::size_t > pool_mismatches{ 0 };
+	{
+		mth::fraction_pool growing;
+		std::atomic< bool > growing_done{ false };
+		std::vector< std::jthread > readers;
+		for ( int r = 0; r != 2; ++r ) {
+			readers.emplace_back( [&] {
+				while ( !growing_done.load() ) {
+					const auto n = (mth::fraction_pool<>::id_type)growing.size();
+					for ( mth::fraction_pool<>::id_type id = 0; id < n; id += 7 ) {
+						const auto rank = growing.rank( id );
+						const bool right =
+							( growing.at( id ) == Fraction{ std::int64_t{ id } } ) &&
+							( growing.to_double( id ) == (double)id ) &&
+							( ( rank == id ) || ( rank == mth::fraction_pool<>::npos ) ) &&
+							( growing.compare( id, n - 1 ) == ( id <=> n - 1 ) );
+						pool_mismatches.fetch_add( right ? 0 : 1 );
+					};
+				};
+			} );
+		};
+		for ( std::int64_t i = 0; i != 5000; ++i ) {
+			(void)growing.intern( Fraction{ i } );
+			if ( i % 500 == 0 ) {
+				growing.sort();
+			};
+		};
+		growing_done.store( true );
+	};
+	std::cout << "fraction_pool_concurrent: mismatches="
+			  << check( std::to_string( pool_mismatches.load() ), "0" ) << '\n';
+
+	const std::array< Fraction, 6 > prices{ { { 101, 4 }, { 51, 2 },
+											  { 203, 8 }, { 51, 2 },
+											  { 203, 8 }, { 26, 1 } } };
+	std::array< Fraction, prices.size() > decoded;
+	const auto dict = mth::dictionary_column<>::encode( prices );
+	dict.decode( decoded );
+	std::cout << "dictionary_column: dict="
+			  << check( std::to_string( dict.dictionary().size() ), "4" )
+			  << ",decoded="
+			  << check( decoded == prices ? "true" : "false", "true" );
+	const auto frame = mth::for_column<>::encode( prices );
+	frame->decode( decoded );
+	mth::fraction_soa<> soa;
+	frame->decode( soa );
+	std::cout << ",for_column: den="
+			  << check( std::to_string( frame->denominator() ), "8" )
+			  << ",decoded="
+			  << check( decoded == prices ? "true" : "false", "true" )
+			  << ",soa[2]=" << check( std::to_string( soa.num[2] ), "203" );
+	std::array sorted_prices = prices;
+	std::ranges::sort( sorted_prices );
+	const auto unsorted = mth::delta_column<>::encode( prices );
+	const auto delta = mth::delta_column<>::encode( sorted_prices );
+	delta->decode( decoded );
+	std::cout << ",delta_column: unsorted="
+			  << check( unsorted ? "encoded" : "nullopt", "nullopt" )
+			  << ",decoded="
+			  << check( decoded == sorted_prices ? "true" : "false", "true" )
+			  << '\n';
+
+	const auto farey = mth::reduced_fractions( Fraction{ 1, 3 }, 1_f, 5l, 2 );
+	std::string farey_s{};
+	for ( const auto &ff : farey ) {
+		farey_s += ff.to_string();
+	};
+	const auto [farey_l, farey_r] = mth::farey_neighbours( f[16], 100l );
+	// x * b overflows int64 here.
+	const auto [farey_big_l, farey_big_r] =
+		mth::farey_neighbours( Fraction{ 1234567890123l, 9876543210987l }, 1000l );
+	std::cout << "reduced_fractions: [1/3,1],q<=5:"
+			  << check( farey_s, "(1/3)(2/5)(1/2)(3/5)(2/3)(3/4)(4/5)1" )
+			  << ",farey_neighbours(" << f[16].to_string() << ",100):"
+			  << check( farey_l.to_string() + farey_r.to_string(),
+						"(33/100)(1/3)" )
+			  << ",large_den:"
+			  << check( farey_big_l.to_string() + farey_big_r.to_string(),
+						"(124/993)(1/8)" )
+			  << '\n';
+
+	std::array< std::optional< Fraction >, f.size() > roots;
+	std::string sq_s{};
+	std::string cb_s{};
+	const auto sq_found =
+		mth::abs_sq_roots( std::span< const Fraction >{ f }, roots );
+	for ( const auto &root : roots ) {
+		sq_s += root ? root->to_string() : "-";
+	};
+	const auto cb_found =
+		mth::cb_roots( std::span< const Fraction >{ f }, roots );
+	for ( const auto &root : roots ) {
+		cb_s += root ? root->to_string() : "-";
+	};
+	const Fraction big_sq{ 3037000493l * 3037000493l, 1 };
+	std::cout << "abs_sq_roots: " << check( std::to_string( sq_found ), "5" )
+			  << ":" << check( sq_s, "-0(1/0)(1/2)---(5/7)--(7/5)------" )
+			  << ",cb_roots: " << check( std::to_string( cb_found ), "3" ) << ":"
+			  << check( cb_s, "-0(1/0)--------(2/3)-----" )
+			  << ",abs_sq_root(3037000493^2)="
+			  << check( mth::abs_sq_root( big_sq )->to_string(), "3037000493" )
+			  << ",abs_sq_root(3037000493^2+2)="
+			  << check( mth::abs_sq_root( big_sq + 2l ) ? "root" : "none",
+						"none" )
+			  << '\n';
+
+	auto &cache = mth::root_cache< std::int64_t >::instance();
+	cache.clear();
+	const auto simp_1 = f[13].simplify_sqrt();
+	const auto simp_2 = f[13].simplify_cbrt();
+	std::cout << "root_cache: " << simp_1.first.to_string()
+			  << simp_1.second.to_string() << simp_2.first.to_string()
+			  << simp_2.second.to_string()
+			  << ",hits=" << check( std::to_string( cache.hits() ), "2" )
+			  << ",misses=" << check( std::to_string( cache.misses() ), "2" )
+			  << '\n';
+
+	const std::array< Fraction, 4 > sample{
+		{ { 1, 2 }, { 1, 3 }, { 1, 6 }, { 2, 3 } } };
+	const auto stats = mth::accumulate_stats( std::span< const Fraction >{ sample }, 2 );
+	mth::running_stats< Fraction > pairs;
+	for ( const auto &x : sample ) {
+		pairs.add( x, x * 2l );
+	};
+	// Sums far past int64, with a small exact variance, and sums past even
+	// the widened type.
+	mth::running_stats< Fraction > large;
+	for ( std::int64_t i = 0; i != 20000; ++i ) {
+		large.add( Fraction{ ( i % 2 == 0 ) ? 999999l : 1000001l } );
+	};
+	mth::running_stats< Fraction > overflowing;
+	for ( std::int64_t i = 0; i != 4; ++i ) {
+		overflowing.add( Fraction{ 1, 3037000499l + i } );
+	};
+	const auto stats_string = []( const std::optional< Fraction > &x ) {
+		return x ? x->to_string() : std::string{ "none" };
+	};
+	std::cout << "running_stats: mean=" << check( stats_string( stats.mean() ), "(5/12)" )
+			  << ",variance=" << check( stats_string( stats.variance() ), "(5/144)" )
+			  << ",sample_variance="
+			  << check( stats_string( stats.sample_variance() ), "(5/108)" )
+			  << ",covariance="
+			  << check( stats_string( pairs.covariance() ), "(5/72)" )
+			  << ",variance_d=" << std::to_string( stats.variance_d() )
+			  << ",large_variance=" << check( stats_string( large.variance() ), "1" )
+			  << ",overflow="
+			  << check( stats_string( overflowing.sum() ) +
+							( overflowing.overflowed() ? ",overflowed" : "" ),
+						"none,overflowed" )
+			  << '\n';
+
+	std::array selected = f;
+	mth::nth_element( selected.begin(), selected.begin() + 5, selected.end() );
+	std::array ordered = f;
+	std::array quartiles = f;
+	std::array< Fraction, 4 > even{ { { 7, 2 }, { -1, 3 }, { 5, 4 }, { 1, 6 } } };
+	std::cout << "nth_element: [5]="
+			  << check( selected[5].to_string(), "(8/27)" ) << ",median="
+			  << check( mth::median( ordered )->to_string(), "(56/45)" )
+			  << ",quantile(1/4)="
+			  << check( mth::quantile( quartiles, Fraction{ 1, 4 } )->to_string(),
+						"(1/4)" )
+			  << ",median(even)=" << check( mth::median( even )->to_string(), "(17/24)" )
+			  << ",quantile(1/2,even)="
+			  << check( mth::quantile( even, Fraction{ 1, 2 } )->to_string(), "(17/24)" )
+			  << ",quantile(1/6,even)="
+			  << check( mth::quantile( even, Fraction{ 1, 6 } )->to_string(), "(-1/12)" )
+			  << ",quantile(3/2)="
+			  << check( mth::quantile( even, Fraction{ 3, 2 } ) ? "value" : "none", "none" )
+			  << ",median(empty)="
+			  << check( mth::median( std::span< Fraction >{} ) ? "value" : "none", "none" )
+			  << '\n';
+
+	auto quarters = *mth::histogram<>::from_edges( { 0_f, { 1, 4 }, { 1, 2 }, { 3, 4 }, 1_f } );
+	auto uneven = *mth::histogram<>::from_edges( { 0_f, { 1, 3 }, { 1, 2 }, 2_f, 7_f } );
+	// Edges whose differences do not fit in int64, which are searched.
+	auto wide_edges = *mth::histogram<>::from_edges(
+		{ Fraction{ 1, 4294967311l }, Fraction{ 1, 4294967291l }, 1_f } );
+	const bool degenerate = mth::histogram<>::from_edges( { 1_f, 1_f } ) ||
+							mth::histogram<>::from_edges( { 1_f } ) ||
+							mth::histogram<>::from_edges( { 2_f, 1_f } );
+	quarters.fill( f, 2 );
+	uneven.fill( f, 2 );
+	std::string quarters_s{};
+	std::string uneven_s{};
+	for ( std::size_t i = 0; i != quarters.bins(); ++i ) {
+		quarters_s += std::to_string( quarters.bin_counts()[i] ) + ',';
+		uneven_s += std::to_string( uneven.bin_counts()[i] ) + ',';
+	};
+	std::cout << "histogram: uniform="
+			  << check( quarters.is_uniform() ? "true" : "false", "true" )
+			  << ":" << check( quarters_s, "2,4,0,0," ) << "under="
+			  << check( std::to_string( quarters.under() ), "2" ) << ",over="
+			  << check( std::to_string( quarters.over() ), "9" ) << ",uniform="
+			  << check( uneven.is_uniform() ? "true" : "false", "false" ) << ":"
+			  << check( uneven_s, "5,1,4,3," ) << "over="
+			  << check( std::to_string( uneven.over() ), "2" ) << ",wide_edges="
+			  << check( std::to_string( wide_edges.bin( Fraction{ 1, 4294967300l } ) ) +
+							std::to_string( wide_edges.bin( Fraction{ 1, 2 } ) ) +
+							( wide_edges.is_uniform() ? "uniform" : "" ),
+						"01" )
+			  << ",degenerate=" << check( degenerate ? "accepted" : "none", "none" )
+			  << '\n';
+
+	// Searched with denominators near 2^61, whose products overflow int64,
+	// either side of an edge and well inside the first bin.
+	const auto searched = *mth::histogram<>::from_edges(
+		{ 0_f, Fraction{ 2147483647l, 4294967296l }, Fraction{ 3, 4 }, 1_f } );
+	const std::int64_t near_edge = 2147483647l << 29;
+	std::cout << "histogram_search: uniform="
+			  << check( searched.is_uniform() ? "true" : "false", "false" ) << ",bins="
+			  << check( std::to_string( searched.bin(
+							Fraction{ near_edge - 1, std::int64_t{ 1 } << 61 } ) ) +
+							std::to_string( searched.bin(
+								Fraction{ near_edge + 1, std::int64_t{ 1 } << 61 } ) ) +
+							std::to_string( searched.bin( Fraction{
+								464863856757003643l, 2581601710226157025l } ) ),
+						"010" )
+			  << '\n';
+
+	const mth::farey_distribution<> farey_5{ 5 };
+	std::string farey_5_s{};
+	for ( std::uint64_t k = 0; k != farey_5.size(); ++k ) {
+		farey_5_s += farey_5.select( k ).to_string();
+	};
+	std::mt19937_64 gen{ 42 };
+	std::vector< Fraction > drawn( 1000 );
+	const mth::log_uniform_distribution<> log_uniform{ 1000 };
+	log_uniform.fill( gen, std::span< Fraction >{ drawn } );
+	const auto log_uniform_reduced = std::ranges::count_if(
+		drawn, []( const auto &x ) { return std::gcd( x.num(), x.den() ) == 1; } );
+	const auto twelfths = *mth::coprime_distribution<>::from_range( 12, -1, 1 );
+	twelfths.fill( gen, std::span< Fraction >{ drawn } );
+	const auto twelfths_in_range =
+		std::ranges::count_if( drawn, []( const auto &x ) {
+			return ( x.den() == 12 ) && ( -1_f <= x ) && ( x < 1_f );
+		} );
+	std::cout << "random: farey(5)="
+			  << check( farey_5_s,
+						"1(1/2)(1/3)(2/3)(1/4)(3/4)(1/5)(2/5)(3/5)(4/5)" )
+			  << ",rank(3/5)="
+			  << check( std::to_string( farey_5.rank( Fraction{ 3, 5 } ) ), "8" )
+			  << ",log_uniform reduced="
+			  << check( std::to_string( log_uniform_reduced ), "1000" )
+			  << ",twelfths in range="
+			  << check( std::to_string( twelfths_in_range ), "1000" ) << '\n';
+
+	// Empty ranges and denominators that are not positive give nothing, and a
+	// large denominator needs no table of its totatives.
+	const auto wide_den = mth::coprime_distribution<>::from_range( 2'147'483'646, -3, 3 );
+	const Fraction wide_draw = ( *wide_den )( gen );
+	std::cout << "random_coprime: invalid="
+			  << check( ( mth::coprime_distribution<>::from_range( 10, 3, 3 ) ||
+						  mth::coprime_distribution<>::from_range( 0 ) ||
+						  mth::coprime_distribution<>::from_range( -5 ) ||
+						  mth::coprime_distribution<>::from_range(
+							  2, 0, std::numeric_limits< std::int64_t >::max() ) )
+							? "some"
+							: "none",
+						"none" )
+			  << ",wide=" << check( ( ( wide_draw.den() == 2'147'483'646 ) &&
+									  ( -3_f <= wide_draw ) && ( wide_draw < 3_f ) )
+										? "true"
+										: "false",
+									"true" )
+			  << '\n';
+
+	using Point = mth::point2<>;
+	const Point origin{ 0_f, 0_f };
+	const Point third{ { 1, 3 }, { 1, 3 } };
+	const Point near{ { 1000000007, 3000000021 }, { 1000000008, 3000000021 } };
+	const Point on{ { 1000000007, 3000000021 }, { 1000000007, 3000000021 } };
+	const Point east{ 1_f, 0_f };
+	const Point north{ 0_f, 1_f };
+	const Point west{ -1_f, 0_f };
+	const Point pythagorean{ { 3, 5 }, { -4, 5 } };
+	const mth::point3<> base[3]{
+		{ 0_f, 0_f, 0_f }, { 1_f, 0_f, 0_f }, { 0_f, 1_f, 0_f } };
+	std::cout << "geometry: orient2d="
+			  << check( std::to_string( mth::orient2d( origin, third, near ) ), "1" )
+			  << "," << check( std::to_string( mth::orient2d( origin, third, on ) ), "0" )
+			  << ",incircle="
+			  << check( std::to_string( mth::incircle( east, north, west, pythagorean ) ),
+						"0" )
+			  << "," << check( std::to_string( mth::incircle( east, north, west, third ) ),
+						"1" )
+			  << ",orient3d="
+			  << check( std::to_string( mth::orient3d( base[0], base[1], base[2],
+													   { third.x, third.y, { -1, 7 } } ) ),
+						"1" )
+			  << '\n';
+
+	using Segment = mth::segment<>;
+	const std::array< Segment, 4 > segments{
+		{ { origin, { 2_f, 2_f } },
+		  { { 0_f, 2_f }, { 2_f, 0_f } },
+		  { { 1_f, -1_f }, { 1_f, 3_f } },
+		  { { { 1, 3 }, 0_f }, { { 1, 3 }, 1_f } } } };
+	std::string crossings{};
+	for ( const auto &found :
+		  mth::intersections( std::span< const Segment >{ segments }, 2 ) ) {
+		const auto point = found.point.to_point();
+		crossings += '{' + point->x.to_string() + ',' + point->y.to_string();
+		for ( const auto i : found.segments ) {
+			crossings += ',' + std::to_string( i );
+		};
+		crossings += '}';
+	};
+	std::cout << "intersections: "
+			  << check( crossings, "{(1/3),(1/3),0,3}{1,1,0,1,2}" ) << '\n';
+
+	// Rotate a quarter turn, halve and move right by 1/3.
+	const auto turn = mth::affine2<>::from_matrix(
+		{ { { { 0_f, Fraction{ -1, 2 }, Fraction{ 1, 3 } } },
+			{ { Fraction{ 1, 2 }, 0_f, 0_f } } } } );
+	mth::affine2<>::points corners;
+	corners[0].num = { 0, 1, 3 };
+	corners[0].den = { 1, 4, 5 };
+	corners[1].num = { 0, 1, 2 };
+	corners[1].den = { 1, 4, 7 };
+	const auto failed = turn->apply( corners, corners );
+	std::string turned{};
+	for ( std::size_t i = 0; i != corners[0].size(); ++i ) {
+		turned += '{' + Fraction{ corners[0].num[i], corners[0].den[i] }.to_string() +
+				  ',' + Fraction{ corners[1].num[i], corners[1].den[i] }.to_string() +
+				  '}';
+	};
+	std::cout << "affine: denominator="
+			  << check( std::to_string( turn->denominator() ), "6" ) << ",failed="
+			  << check( std::to_string( failed ), "0" ) << ","
+			  << check( turned, "{(1/3),0}{(5/24),(1/8)}{(4/21),(3/10)}" ) << '\n';
+
+	// Coefficients just small enough for the unchecked sums if no coordinate
+	// were the most negative INT, with a point that is.
+	const auto lowest = Fraction::from_reduced( std::numeric_limits< std::int64_t >::min(), 1 );
+	const auto steep =
+		mth::affine2<>::from_matrix( { { { { lowest, lowest, 1_f } }, { { 0_f, 0_f, 0_f } } } } );
+	mth::affine2<>::points extremes;
+	extremes[0].num = { std::numeric_limits< std::int64_t >::min(), 1 };
+	extremes[0].den = { 1, 1 };
+	extremes[1].num = { std::numeric_limits< std::int64_t >::min(), -1 };
+	extremes[1].den = { 1, 1 };
+	const auto steep_failed = steep->apply( extremes, extremes );
+	std::cout << "affine_extremes: failed="
+			  << check( std::to_string( steep_failed ), "1" ) << ",second="
+			  << check( Fraction{ extremes[0].num[1], extremes[0].den[1] }.to_string(), "1" )
+			  << '\n';
+
+	// An arch with its middle control point pulled up by weight 2.
+	using Arch = mth::bezier<>;
+	const std::array< Arch::point, 3 > arch_points{
+		{ { 0_f, 0_f }, { 1_f, 2_f }, { 2_f, 0_f } } };
+	const std::array< Fraction, 3 > arch_weights{ 1_f, 2_f, 1_f };
+	const auto arch =
+		Arch::from_points( arch_points, std::span< const Fraction >{ arch_weights } );
+	const auto top = ( *arch )( Fraction{ 1, 2 } );
+	const auto halves = arch->split( Fraction{ 1, 2 } );
+	const auto middle = halves->first.control_point( 2 );
+	std::cout << "bezier: top=" << check( ( *top )[0].to_string(), "1" ) << ","
+			  << check( ( *top )[1].to_string(), "(4/3)" ) << ",split="
+			  << check( middle[0].to_string() + middle[1].to_string(), "1(4/3)" )
+			  << ",weight="
+			  << check( halves->first.weight( 2 ).to_string(), "(3/2)" ) << '\n';
+
+	// ( x^2 - 1 ) / ( x - 1 ), and a unit feedback loop around 1 / ( s + 1 ).
+	using Rational = mth::rational_function<>;
+	const auto s = Rational::variable();
+	const Rational unit{ 1_f };
+	Rational hole = ( s * s - unit ) / ( s - unit );
+	const std::string uncancelled = hole.to_string();
+	hole.cancel();
+	const Rational plant = unit / ( s + unit );
+	const Rational loop = plant / ( unit + plant );
+	std::cout << "rational: " << check( uncancelled, "(x^2-1)/(x-1)" ) << ","
+			  << check( hole.to_string(), "(x+1)" ) << ","
+			  << check( hole( 1_f )->to_string(), "2" ) << ","
+			  << check( loop.to_string(), "(x+1)/(x^2+3x+2)" ) << ","
+			  << check( loop( Fraction{ 1, 2 } )->to_string(), "(2/5)" ) << '\n';
+
+	// The lattice spanned by the rows of a rational matrix.
+	const std::array< Fraction, 9 > spanning{ Fraction{ 1, 2 }, 1_f, 1_f,
+											  Fraction{ -3, 2 }, Fraction{ 3, 2 }, 3_f,
+											  Fraction{ 5, 2 }, -1_f, -4_f };
+	const auto cleared =
+		mth::clear_denominators( std::span< const Fraction >{ spanning }, 3 );
+	const auto hermite = mth::hermite( cleared->first );
+	const auto smith = mth::smith( cleared->first, true );
+	const auto matrix_string = []( const mth::int_matrix<> &m ) {
+		std::string result{};
+		for ( const auto x : m.data ) {
+			result += std::to_string( x ) + ' ';
+		};
+		return result;
+	};
+	const auto product = smith->left.times( cleared->first )->times( smith->right );
+	std::cout << "lattice: denominator="
+			  << check( std::to_string( cleared->second ), "2" ) << ",hermite="
+			  << check( matrix_string( hermite->form ), "1 2 2 0 3 0 0 0 6 " )
+			  << ",smith="
+			  << check( matrix_string( smith->form ), "1 0 0 0 3 0 0 0 6 " )
+			  << ",transform="
+			  << check( ( *product == smith->form ) ? "true" : "false", "true" )
+			  << '\n';
+
+	// A transform for a 5 x 4 matrix whose unreduced U overflowed, and the
+	// most negative entry, which cannot be negated, taken as overflow.
+	mth::int_matrix<> tall{ 5, 4 };
+	tall.data = { -22, -22, -3, -29, -9, 25, -2, -26, 4, 8, -25, 3, 18, -17, -5, -15,
+				  -13, 18, -2, -14 };
+	const auto tall_hermite = mth::hermite( tall, true );
+	const bool tall_short =
+		tall_hermite && std::ranges::all_of( tall_hermite->left.data, []( const auto x ) {
+			return std::abs( x ) < 100'000'000;
+		} );
+	mth::int_matrix<> most_negative{ 2, 1 };
+	most_negative.data = { std::numeric_limits< std::int64_t >::min(), -1 };
+	std::cout << "lattice_overflow: transform="
+			  << check( ( tall_hermite &&
+						  ( tall_hermite->left.times( tall ) == tall_hermite->form ) )
+							? "true"
+							: "false",
+						"true" )
+			  << ",short=" << check( tall_short ? "true" : "false", "true" )
+			  << ",most_negative="
+			  << check( ( mth::hermite( most_negative ) ||
+						  mth::smith( most_negative, true ) )
+							? "some"
+							: "none",
+						"none" )
+			  << '\n';
+
+	// Read, split, convert, sum and write, two records at a time.
+	std::istringstream records{ "1/2 0.25\n3e-1, -1.5 none\n" };
+	std::ostringstream summed{};
+	std::size_t rejected = 0;
+	{
+		mth::pipeline_pool pool{ 2 };
+		mth::channel< std::string > lines{ 2 }, fields{ 2 };
+		mth::channel< Fraction > values{ 2 }, totals{ 2 };
+		pool.run( mth::read_lines( records, lines ), mth::split_fields( lines, fields ),
+				  mth::convert_fractions( fields, values, &rejected ),
+				  mth::reduce( values, totals, 0_f, std::plus<>{} ),
+				  mth::write_lines( totals, summed ) );
+	};
+	std::cout << "pipeline: " << check( summed.str(), "(-9/20)\n" ) << ",rejected="
+			  << check( std::to_string( rejected ), "1" ) << '\n';
+
+	// Thousands of records through channels of 2 on 4 threads, so stages
+	// suspend and are resumed all the time; none may be lost.
+	std::string stress_records{};
+	std::string stress_expected{};
+	for ( std::size_t i = 0; i != 3000; ++i ) {
+		stress_records += "1/3 2/3," + std::to_string( i ) + '\n';
+		stress_expected += std::to_string( i + 1 ) + '\n';
+	};
+	std::size_t stress_lost = 0;
+	for ( std::size_t run = 0; run != 20; ++run ) {
+		std::istringstream in{ stress_records };
+		std::ostringstream out{};
+		{
+			mth::pipeline_pool pool{ 4 };
+			mth::channel< std::string > lines{ 2 }, fields{ 2 };
+			mth::channel< Fraction > values{ 2 }, totals{ 2 };
+			pool.run( mth::read_lines( in, lines ), mth::split_fields( lines, fields ),
+					  mth::convert_fractions( fields, values ),
+					  mth::reduce( values, totals, 0_f, std::plus<>{}, 3 ),
+					  mth::write_lines( totals, out ) );
+		};
+		stress_lost += ( out.str() == stress_expected ) ? 0 : 1;
+	};
+	std::cout << "pipeline_stress: lost=" << check( std::to_string( stress_lost ), "0" )
+			  << '\n';
+
+	// Zero with any exponent is 0 at once, and a power of ten past digits10
+	// is not tried exactly.
+	std::string parsed{};
+	for ( const std::string_view text :
+		  { "0e2147483647", "-0.0e-2147483647", "25e-1", "1e18", "1e19" } ) {
+		const auto f = mth::parse_fraction( text );
+		parsed += f ? f->to_string() + ' ' : "none ";
+	};
+	std::cout << "parse: " << check( parsed, "0 0 (5/2) 1000000000000000000 none " )
+			  << '\n';
+
+	// A few conversions and simplifications, each batch a single chunk.
+	const std::array< double, 5 > doubles{ 0.5, 1e-5, 0.75, -2.5, 0.125 };
+	std::array< Fraction, 5 > converted{};
+	mth::to_fractions< std::int64_t, -6 >( doubles, converted, 3 );
+	const std::array< Fraction, 2 > radicands{ Fraction{ 8, 9 }, 54_f };
+	std::array< std::pair< Fraction, Fraction >, 2 > simplified{};
+	mth::simplify_sqrts< std::int64_t, -6 >( radicands, simplified, 3 );
+	std::cout << "batch: " << check( converted[1].to_string(), Fraction{ 1e-5 }.to_string() ) << ','
+			  << check( converted[3].to_string(), "(-5/2)" ) << ','
+			  << check( simplified[0].first.to_string() + simplified[0].second.to_string(),
+						"(2/3)2" )
+			  << '\n';
+
+	// Thousands of conversions over 4 threads, the first eighth of them
+	// hundreds of times slower, so that the threads starting with the fast
+	// ones run out and steal. Each index must be run exactly once.
+	std::vector< double > skewed( 4096, 0.5 );
+	std::fill_n( skewed.begin(), skewed.size() / 8, 1e-3 );
+	std::vector< Fraction > skewed_out( skewed.size() );
+	std::vector< std::atomic< int > > skewed_runs( skewed.size() );
+	mth::parallel_for(
+		skewed.size(), 1,
+		[&]( const std::size_t begin, const std::size_t end ) {
+			for ( std::size_t i = begin; i != end; ++i ) {
+				skewed_out[i] = Fraction{ skewed[i] };
+				skewed_runs[i].fetch_add( 1 );
+			};
+		},
+		4 );
+	const bool skewed_once = std::ranges::all_of(
+		skewed_runs, []( const auto &runs ) { return runs.load() == 1; } );
+	const bool skewed_right = std::ranges::all_of( skewed_out, []( const auto &f ) {
+		return ( f == Fraction{ 1, 2 } ) || ( f == Fraction{ 1, 1000 } );
+	} );
+	// The deque on its own: the owner pushes three for each it takes, growing
+	// well past its first 64, while 3 thieves steal, racing the owner for the
+	// last. Each value must come out exactly once.
+	constexpr std::uint64_t deque_values = 100'000;
+	std::vector< std::atomic< int > > deque_seen( deque_values );
+	std::atomic< std::uint64_t > deque_stolen{ 0 };
+	{
+		mth::detail::stealing_deque deque{};
+		std::atomic< bool > deque_done{ false };
+		std::vector< std::jthread > thieves;
+		for ( int i = 0; i != 3; ++i ) {
+			thieves.emplace_back( [&] {
+				while ( !deque_done.load() ) {
+					if ( const auto x = deque.steal() ) {
+						deque_seen[*x].fetch_add( 1 );
+						deque_stolen.fetch_add( 1 );
+					} else {
+						std::this_thread::yield();
+					};
+				};
+			} );
+		};
+		for ( std::uint64_t i = 0; i != deque_values; ++i ) {
+			deque.push( i );
+			if ( i % 3 == 2 ) {
+				if ( const auto x = deque.take() ) {
+					deque_seen[*x].fetch_add( 1 );
+				};
+			};
+		};
+		while ( const auto x = deque.take() ) {
+			deque_seen[*x].fetch_add( 1 );
+		};
+		deque_done.store( true );
+	};
+	const bool deque_once = std::ranges::all_of(
+		deque_seen, []( const auto &seen ) { return seen.load() == 1; } );
+	std::cout << "batch_stealing: once="
+			  << check( skewed_once ? "true" : "false", "true" ) << ",values="
+			  << check( skewed_right ? "true" : "false", "true" ) << ",deque="
+			  << check( deque_once ? "true" : "false", "true" ) << ",stolen="
+			  << check( ( deque_stolen.load() != 0 ) ? "some" : "none", "some" ) << '\n';
+
+	// Balanced sums, products and common denominators, over 2 threads.
+	const std::array< Fraction, 6 > terms{ Fraction{ 1, 2 }, Fraction{ 2, 3 },
+										   Fraction{ 3, 4 }, Fraction{ 4, 5 },
+										   Fraction{ 5, 6 }, Fraction{ -7, 10 } };
+	const std::array< Fraction, 2 > too_big{ Fraction{ INT64_MAX, 3 },
+											 Fraction{ INT64_MAX, 5 } };
+	std::cout << "tree: sum="
+			  << check( mth::tree_sum< std::int64_t, -6 >( terms, 2 )->to_string(),
+						"(57/20)" )
+			  << ",product="
+			  << check(
+					 mth::tree_product< std::int64_t, -6 >( terms, 2 )->to_string(),
+					 "(-7/60)" )
+			  << ",lcm="
+			  << check( std::to_string( *mth::lcm_all< std::int64_t, -6 >( terms, 2 ) ),
+						"60" )
+			  << ",overflow="
+			  << check( mth::tree_sum< std::int64_t, -6 >( too_big ) ? "value" : "none",
+						"none" )
+			  << '\n';
+
+	// Enough terms for 4 threads, the shares combined across them.
+	std::vector< Fraction > many_terms( 20000 );
+	for ( std::size_t i = 0; i != many_terms.size(); ++i ) {
+		many_terms[i] = Fraction{ 1, (std::int64_t)( i % 6 + 1 ) };
+	};
+	std::cout << "tree_threads: sum="
+			  << check( mth::tree_sum< std::int64_t, -6 >( many_terms, 4 )->to_string(),
+						"(163347/20)" )
+			  << ",lcm="
+			  << check(
+					 std::to_string( *mth::lcm_all< std::int64_t, -6 >( many_terms, 4 ) ),
+					 "60" )
+			  << '\n';
+
+	// Arithmetic, comparison, conversion and to_chars must not allocate.
+	// to_string() and the string operators do, once the string is longer
+	// than the small string buffer.
+	const Fraction long_a{ INT64_MAX - 2, 3 };
+	const Fraction long_b{ -7, 1000000007 };
+	const Fraction small_a{ 3, 4 };
+	const Fraction small_b{ -5, 6 };
+	std::array< char, Fraction::max_chars > chars{};
+	volatile bool sink = false;
+	const std::size_t computing = allocations_in( [&] {
+		sink = sink != ( small_a + small_b == small_a * small_b / small_b - small_b );
+		sink = sink != ( ( small_a <=> small_b ) < 0 );
+		sink = sink != ( Fraction{ 0.333 } == Fraction{ 2.5 } );
+		sink = sink != ( mth::to_fraction_using_continued_fractions( 0.7071 ).num() == 0 );
+		sink = sink != ( to_chars( chars.data(), chars.data() + chars.size(), long_a )
+							 .ec == std::errc{} );
+	} );
+	const auto allocating = [&]( const auto &f ) {
+		return ( allocations_in( f ) != 0 ) ? "allocates" : "none";
+	};
+	std::cout << "allocations: computing=" << check( std::to_string( computing ), "0" )
+			  << ",to_chars="
+			  << check( std::string( chars.data(),
+									 to_chars( chars.data(), chars.data() + chars.size(),
+											   long_a )
+										 .ptr ),
+						"(9223372036854775805/3)" )
+			  << ",to_string="
+			  << check( allocating( [&] { sink = long_a.to_string().empty(); } ),
+						"allocates" )
+			  << ",operator+="
+			  << check( allocating( [&] {
+							sink = ( long_b + std::string{ " total" } ).empty();
+						} ),
+						"allocates" )
+			  << ",to_string(cf)="
+			  << check( allocating( [&] {
+							sink = mth::to_string( mth::to_continued_fraction< 25 >(
+													   0.7071 ) )
+									   .empty();
+						} ),
+						"allocates" )
+			  << '\n';
+
+	// What each conversion took, and over a small feed.
+	const auto report = mth::to_fraction_with_report( 0.75 );
+	const std::array< double, 3 > feed{ 0.75, 0.5, std::numeric_limits< double >::infinity() };
+	const auto summary = mth::summarise_conversions( feed );
+	std::cout << "report: " << check( report.value.to_string(), "(3/4)" )
+			  << ",iterations=" << check( std::to_string( report.iterations ), "3" )
+			  << ",within_error="
+			  << check( ( report.stop == mth::conversion_stop::within_error ) ? "true"
+																			: "false",
+						"true" )
+			  << ",converted=" << check( std::to_string( summary.converted() ), "2" )
+			  << ",out_of_range="
+			  << check( std::to_string(
+							summary.count( mth::conversion_stop::out_of_range ) ),
+						"1" )
+			  << ",mean_iterations="
+			  << check( std::to_string( summary.mean_iterations() ), "2.000000" )
+			  << '\n';
+
+	// The report runs the plain converters' loops, so gives the same values.
+	std::size_t report_differs = 0;
+	for ( const double d : { 0.75, 3.14159265358979, -2.718281828, 1e-4, 12345.678 } ) {
+		report_differs +=
+			( mth::to_fraction_with_report( d ).value != Fraction{ d } ) ||
+			( mth::to_fraction_with_report( d, mth::conversion_method::continued_fractions )
+				  .value != mth::to_fraction_using_continued_fractions( d ) );
+	};
+	const auto limited = mth::to_fraction_with_report( 1e-4, mth::conversion_method::stern_brocot,
+													   100 );
+	std::cout << "report_loops: differs=" << check( std::to_string( report_differs ), "0" )
+			  << ",limited="
+			  << check( std::to_string( limited.iterations ) +
+							( ( limited.stop == mth::conversion_stop::iteration_limit )
+								  ? ",iteration_limit"
+								  : ",within_error" ),
+						"100,iteration_limit" )
+			  << '\n';
+
+	// Fractions out through the Arrow C data interface and back, in place.
+	const std::array< Fraction, 3 > to_export{ Fraction{ 1, 2 }, Fraction{ std::int64_t{ -7 } },
+											   Fraction{ 2, 3 } };
+	ArrowArray arrow_array;
+	ArrowSchema arrow_schema;
+	const bool exported =
+		mth::to_arrow( std::span< const Fraction >{ to_export }, arrow_array, arrow_schema );
+	const auto arrow_list = []( const auto &column ) {
+		std::string result;
+		for ( std::size_t i = 0; i != column.size(); ++i ) {
+			result += ( i == 0 ? "" : "," ) + column[i].to_string();
+		};
+		return result;
+	};
+	std::string arrow_format = arrow_schema.format;
+	arrow_format += ':';
+	arrow_format += arrow_schema.children[0]->format;
+	arrow_format += arrow_schema.children[1]->format;
+	// A slice of the same array, as a consumer may pass it back.
+	ArrowArray sliced = arrow_array;
+	arrow_array.release = nullptr;
+	sliced.offset = 1;
+	sliced.length = 2;
+	const auto sliced_column = mth::arrow_column<>::from_arrow( sliced, arrow_schema );
+	// The soa's vectors become the array's buffers.
+	mth::fraction_soa<> arrow_soa;
+	arrow_soa.num = { 3, -5 };
+	arrow_soa.den = { 7, 4 };
+	const std::int64_t *arrow_nums = arrow_soa.num.data();
+	std::int64_t *const arrow_dens = arrow_soa.den.data();
+	ArrowArray zero_den;
+	ArrowSchema zero_den_schema;
+	const bool moved_out = mth::to_arrow( std::move( arrow_soa ), zero_den, zero_den_schema );
+	const bool zero_copy = zero_den.children[0]->buffers[1] == arrow_nums;
+	// As another producer might give it, with a 0 denominator.
+	arrow_dens[0] = 0;
+	const auto arrow_rejected = mth::arrow_column<>::from_arrow( zero_den, zero_den_schema );
+	const bool still_owned = zero_den.release != nullptr;
+	zero_den.release( &zero_den );
+	zero_den_schema.release( &zero_den_schema );
+	std::cout << "arrow: format=" << check( arrow_format, "+s:ll" ) << ",sliced="
+			  << check( sliced_column ? arrow_list( *sliced_column ) : "none",
+						"(-7),(2/3)" )
+			  << ",taken=" << check( sliced.release == nullptr ? "true" : "false", "true" )
+			  << ",zero_copy=" << check( zero_copy ? "true" : "false", "true" )
+			  << ",zero_den="
+			  << check( arrow_rejected ? "taken" : still_owned ? "none" : "released", "none" )
+			  << '\n';
+	arrow_schema.release( &arrow_schema );
+
+	// Only one denominator is shared, and 0 denominators do not go out.
+	const auto try_export = []( std::vector< std::int64_t > num,
+								std::vector< std::int64_t > den ) {
+		mth::fraction_soa<> soa;
+		soa.num = std::move( num );
+		soa.den = std::move( den );
+		ArrowArray array;
+		ArrowSchema schema;
+		if ( !mth::to_arrow( std::move( soa ), array, schema ) ) {
+			return std::string{ soa.num.size() == 0 ? "moved" : "kept" };
+		};
+		auto column = mth::arrow_column<>::from_arrow( array, schema );
+		schema.release( &schema );
+		std::string result;
+		for ( std::size_t i = 0; i != ( column ? column->size() : 0 ); ++i ) {
+			result += ( *column )[i].to_string();
+		};
+		return result;
+	};
+	const std::array< Fraction, 2 > with_inf{ Fraction{ 1, 2 }, Fraction::f_inf };
+	ArrowArray inf_array;
+	ArrowSchema inf_schema;
+	std::cout << "arrow_export: exported="
+			  << check( ( exported && moved_out ) ? "true" : "false", "true" )
+			  << ",shared=" << check( try_export( { 1, 2, 3 }, { 4 } ), "(1/4)(1/2)(3/4)" )
+			  << ",mismatch=" << check( try_export( { 1, 2, 3 }, { 4, 5 } ), "kept" )
+			  << ",zero=" << check( try_export( { 1, 2 }, { 3, 0 } ), "kept" )
+			  << ",inf="
+			  << check( mth::to_arrow( std::span< const Fraction >{ with_inf }, inf_array,
+									   inf_schema )
+							? "exported"
+							: "none",
+						"none" )
+			  << '\n';
+
+	// Numerators and denominators held elsewhere, as a range of fractions.
+	std::vector< std::int64_t > view_nums{ 1, -3, 2 };
+	std::vector< std::int64_t > view_dens{ 2, 6, 3 };
+	mth::fraction_view view{ view_nums, view_dens };
+	const Fraction view_max = *std::ranges::max_element( view );
+	std::ranges::sort( view );
+	std::string view_arrays;
+	for ( std::size_t i = 0; i != view_nums.size(); ++i ) {
+		view_arrays += std::to_string( view_nums[i] ) + '/' + std::to_string( view_dens[i] ) +
+					   ( i + 1 == view_nums.size() ? "" : " " );
+	};
+	const std::array< double, 2 > view_doubles{ 0.25, -3.0 };
+	std::array< std::int64_t, 2 > batch_nums{};
+	std::array< std::int64_t, 2 > batch_dens{};
+	mth::to_fractions( view_doubles, mth::fraction_view{ batch_nums, batch_dens }, 2 );
+	const std::vector< std::int64_t > reduced_nums{ 5, 7 };
+	const std::vector< std::int64_t > reduced_dens{ 8, 1 };
+	const mth::fraction_view reduced_view{ reduced_nums, reduced_dens, true };
+	std::cout << "view: max=" << check( view_max.to_string(), "(2/3)" ) << ",sorted="
+			  << check( Fraction{ view[0] }.to_string() + Fraction{ view[1] }.to_string() +
+							Fraction{ view[2] }.to_string(),
+						"(-1/2)(1/2)(2/3)" )
+			  << ",arrays=" << check( view_arrays, "-1/2 1/2 2/3" ) << ",batch="
+			  << check( std::to_string( batch_nums[0] ) + '/' +
+							std::to_string( batch_dens[0] ) + ',' +
+							std::to_string( batch_nums[1] ) + '/' +
+							std::to_string( batch_dens[1] ),
+						"1/4,-3/1" )
+			  << ",reduced="
+			  << check( std::to_string( std::ranges::count( reduced_view, Fraction{ 5, 8 } ) ),
+						"1" )
+			  << '\n';
+
+
+	// The std:: algorithms on a view, and the entry points that take one.
+	std::vector< std::int64_t > algo_nums{ 3, 1, -1, 4, 1 };
+	std::vector< std::int64_t > algo_dens{ 4, 2, 3, 5, 8 };
+	mth::fraction_view algo_view{ algo_nums, algo_dens };
+	std::stable_sort( algo_view.begin(), algo_view.end() );
+	const auto view_list = []( const auto &range ) {
+		std::string result;
+		for ( const Fraction f : range ) {
+			result += f.to_string();
+		};
+		return result;
+	};
+	const std::string stable_sorted = view_list( algo_view );
+	std::ranges::rotate( algo_view, algo_view.begin() + 2 );
+	std::ranges::sort( algo_view.begin(), algo_view.begin() + 3 );
+	std::ranges::inplace_merge( algo_view, algo_view.begin() + 3 );
+	const std::vector< std::int64_t > term_nums{ 1, 2, 3, 4, 5, -7 };
+	const std::vector< std::int64_t > term_dens{ 2, 3, 4, 5, 6, 10 };
+	const mth::fraction_view term_view{ term_nums, term_dens };
+	std::vector< std::int64_t > select_nums{ term_nums };
+	std::vector< std::int64_t > select_dens{ term_dens };
+	auto view_histogram = *mth::histogram<>::from_edges( { 0_f, Fraction{ 1, 2 }, 1_f } );
+	view_histogram.fill( term_view, 2 );
+	const std::vector< std::int64_t > radicand_nums{ 8, 54 };
+	const std::vector< std::int64_t > radicand_dens{ 9, 1 };
+	std::array< std::pair< Fraction, Fraction >, 2 > view_simplified{};
+	mth::simplify_sqrts( mth::fraction_view{ radicand_nums, radicand_dens },
+						 view_simplified, 2 );
+	std::cout << "view_algorithms: stable_sort="
+			  << check( stable_sorted, "(-1/3)(1/8)(1/2)(3/4)(4/5)" ) << ",inplace_merge="
+			  << check( view_list( algo_view ), "(-1/3)(1/8)(1/2)(3/4)(4/5)" ) << '\n';
+	std::cout << "view_entry_points: sum="
+			  << check( mth::tree_sum( term_view, 2 )->to_string(), "(57/20)" )
+			  << ",product=" << check( mth::tree_product( term_view )->to_string(), "(-7/60)" )
+			  << ",lcm=" << check( std::to_string( *mth::lcm_all( term_view ) ), "60" )
+			  << ",stats="
+			  << check( mth::accumulate_stats( term_view, 2 ).sum()->to_string(), "(57/20)" )
+			  << ",median="
+			  << check( mth::median( mth::fraction_view{ select_nums, select_dens } )
+							->to_string(),
+						"(17/24)" )
+			  << ",quantile="
+			  << check( mth::quantile( mth::fraction_view{ select_nums, select_dens },
+									   Fraction{ 1, 5 } )
+							->to_string(),
+						"(1/2)" )
+			  << ",histogram="
+			  << check( std::to_string( view_histogram.under() ) +
+							std::to_string( view_histogram.bin_counts()[0] ) +
+							std::to_string( view_histogram.bin_counts()[1] ),
+						"105" )
+			  << ",simplify_sqrts="
+			  << check( view_simplified[0].first.to_string() +
+							view_simplified[0].second.to_string(),
+						"(2/3)2" )
+			  << '\n';
 	return 0;
 }